@@ -0,0 +1,364 @@
+#include "dispatch.h"
+#include "pattern.h"
+#include "little-oscar/osc.h"
+
+#include <string.h>
+
+#define NO_NODE     -1
+
+static void init_node(osc_dispatch_node_t *node, int parent, const char *name, int name_len) {
+    /* `bucket` belongs to the child table, not to the node */
+    node->name          = name;
+    node->name_len      = name_len;
+    node->parent        = parent;
+    node->first_child   = NO_NODE;
+    node->last_child    = NO_NODE;
+    node->next_sibling  = NO_NODE;
+    node->next_in_bucket = NO_NODE;
+    node->address       = NULL;
+    node->method        = NULL;
+    node->userdata      = NULL;
+}
+
+/* FNV-1a over the part, seeded with its parent */
+static uint32_t child_hash(int parent, const char *name, int name_len) {
+    uint32_t hash = 2166136261u ^ ((uint32_t)parent * 2654435761u);
+    int i;
+    for (i = 0; i < name_len; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static int find_child(osc_dispatcher_t *dispatcher, int parent, const char *name, int name_len, uint32_t hash) {
+    int child = dispatcher->nodes[hash & dispatcher->bucket_mask].bucket;
+    while (child != NO_NODE) {
+        osc_dispatch_node_t *node = &dispatcher->nodes[child];
+        if (node->parent == parent && node->name_len == name_len
+            && memcmp(node->name, name, name_len) == 0) break;
+        child = node->next_in_bucket;
+    }
+    return child;
+}
+
+static void index_node(osc_dispatcher_t *dispatcher, int node) {
+    uint32_t hash = osc_address_hash(dispatcher->nodes[node].address);
+    uint32_t i = hash & dispatcher->slot_mask;
+    while (dispatcher->slots[i].node != NO_NODE) i = (i + 1) & dispatcher->slot_mask;
+    dispatcher->slots[i].hash = hash;
+    dispatcher->slots[i].node = node;
+    dispatcher->n_indexed++;
+}
+
+static int find_indexed(osc_dispatcher_t *dispatcher, const char *address, uint32_t hash) {
+    uint32_t i = hash & dispatcher->slot_mask;
+    int node;
+    while ((node = dispatcher->slots[i].node) != NO_NODE) {
+        if (dispatcher->slots[i].hash == hash && strcmp(dispatcher->nodes[node].address, address) == 0) break;
+        i = (i + 1) & dispatcher->slot_mask;
+    }
+    return node;
+}
+
+/* Public Interface */
+
+int osc_dispatcher_init(osc_dispatcher_t *dispatcher, osc_dispatch_node_t *nodes, int max_nodes) {
+    if (max_nodes < 1) return 0;
+    dispatcher->nodes = nodes;
+    dispatcher->max_nodes = max_nodes;
+    dispatcher->n_nodes = 1;
+
+    /* one bucket per node, rounded down to a power of two */
+    uint32_t n_buckets = 1;
+    while (n_buckets * 2 <= (uint32_t)max_nodes) n_buckets *= 2;
+    dispatcher->bucket_mask = n_buckets - 1;
+    int i;
+    for (i = 0; i < (int)n_buckets; i++) nodes[i].bucket = NO_NODE;
+
+    dispatcher->slots = NULL;
+    dispatcher->slot_mask = 0;
+    dispatcher->n_indexed = 0;
+    dispatcher->cache = NULL;
+    dispatcher->cache_mask = 0;
+    dispatcher->generation = 1;
+    dispatcher->cache_hits = 0;
+    dispatcher->cache_misses = 0;
+    init_node(&nodes[0], NO_NODE, "", 0);
+    return 1;
+}
+
+int osc_dispatcher_index(osc_dispatcher_t *dispatcher, osc_dispatch_slot_t *slots, int n_slots) {
+    if (n_slots < 1 || (n_slots & (n_slots - 1))) return 0;
+
+    int node, methods = 0;
+    for (node = 0; node < dispatcher->n_nodes; node++) {
+        if (dispatcher->nodes[node].method) methods++;
+    }
+    /* probes stop at an empty slot, so there must always be one */
+    if (methods >= n_slots) return 0;
+
+    int i;
+    for (i = 0; i < n_slots; i++) slots[i].node = NO_NODE;
+    dispatcher->slots = slots;
+    dispatcher->slot_mask = n_slots - 1;
+    dispatcher->n_indexed = 0;
+    for (node = 0; node < dispatcher->n_nodes; node++) {
+        if (dispatcher->nodes[node].method) index_node(dispatcher, node);
+    }
+    return 1;
+}
+
+int osc_dispatcher_add(osc_dispatcher_t *dispatcher, const char *address, osc_method_fn method, void *userdata) {
+    if (osc_pattern_verify(address) != OSC_PATTERN_STATIC) return 0;
+    if (dispatcher->slots && (uint32_t)dispatcher->n_indexed == dispatcher->slot_mask) return 0;
+
+    osc_dispatch_node_t *nodes = dispatcher->nodes;
+    int node = 0;
+    const char *p = address;
+
+    /* follow the part of the path that already exists */
+    while (*p) {
+        const char *name = p + 1;
+        const char *end = name;
+        while (*end && *end != '/') end++;
+
+        /* methods are leaves */
+        if (nodes[node].method) return 0;
+
+        int child = find_child(dispatcher, node, name, end - name, child_hash(node, name, end - name));
+        if (child == NO_NODE) break;
+        node = child;
+        p = end;
+    }
+
+    /* check there is room for the rest before creating any of it, so that a
+     * failed add leaves no dead containers behind */
+    int needed = 0;
+    const char *q;
+    for (q = p; *q; q++) {
+        if (*q == '/') needed++;
+    }
+    if (dispatcher->max_nodes - dispatcher->n_nodes < needed) return 0;
+
+    while (*p) {
+        const char *name = ++p;
+        while (*p && *p != '/') p++;
+        int name_len = p - name;
+
+        uint32_t hash = child_hash(node, name, name_len);
+        int child = dispatcher->n_nodes++;
+        init_node(&nodes[child], node, name, name_len);
+
+        osc_dispatch_node_t *bucket = &nodes[hash & dispatcher->bucket_mask];
+        nodes[child].next_in_bucket = bucket->bucket;
+        bucket->bucket = child;
+
+        /* append, so that methods matched by a pattern are invoked in
+         * registration order */
+        if (nodes[node].first_child == NO_NODE) {
+            nodes[node].first_child = child;
+        } else {
+            nodes[nodes[node].last_child].next_sibling = child;
+        }
+        nodes[node].last_child = child;
+        node = child;
+    }
+
+    if (nodes[node].method || nodes[node].first_child != NO_NODE) return 0;
+
+    nodes[node].address = address;
+    nodes[node].method = method;
+    nodes[node].userdata = userdata;
+    if (dispatcher->slots) index_node(dispatcher, node);
+
+    /* generation 0 marks unused cache entries */
+    if (++dispatcher->generation == 0) dispatcher->generation = 1;
+    return 1;
+}
+
+int osc_dispatcher_cache(osc_dispatcher_t *dispatcher, osc_dispatch_cache_entry_t *entries, int n_entries) {
+    if (n_entries < 1 || (n_entries & (n_entries - 1))) return 0;
+
+    int i;
+    for (i = 0; i < n_entries; i++) entries[i].generation = 0;
+    dispatcher->cache = entries;
+    dispatcher->cache_mask = n_entries - 1;
+    dispatcher->cache_hits = 0;
+    dispatcher->cache_misses = 0;
+    return 1;
+}
+
+/* ... */
+
+typedef struct {
+    osc_pattern_t       pattern;
+    const char          *name;
+    int                 name_len;
+    int                 is_static;
+} part_t;
+
+/* methods invoked by a pattern dispatch, recorded for the cache */
+typedef struct {
+    int                 *nodes;
+    int                 max;
+    int                 count;          /* exceeds `max` if the list is incomplete */
+} found_t;
+
+static int invoke(osc_dispatch_node_t *node, void *context) {
+    if (!node->method) return 0;
+    node->method(node->address, context, node->userdata);
+    return 1;
+}
+
+static int invoke_found(osc_dispatcher_t *dispatcher, int node, found_t *found, void *context) {
+    if (!invoke(&dispatcher->nodes[node], context)) return 0;
+    if (found) {
+        if (found->count < found->max) found->nodes[found->count] = node;
+        found->count++;
+    }
+    return 1;
+}
+
+static int dispatch_static(osc_dispatcher_t *dispatcher, const char *address, void *context) {
+    if (dispatcher->slots) {
+        int node = find_indexed(dispatcher, address, osc_address_hash(address));
+        return (node == NO_NODE) ? 0 : invoke(&dispatcher->nodes[node], context);
+    }
+
+    int node = 0;
+    const char *p = address;
+    while (*p && node != NO_NODE) {
+        const char *name = ++p;
+        while (*p && *p != '/') p++;
+        node = find_child(dispatcher, node, name, p - name, child_hash(node, name, p - name));
+    }
+    return (node == NO_NODE) ? 0 : invoke(&dispatcher->nodes[node], context);
+}
+
+static int walk(osc_dispatcher_t *dispatcher, int node, part_t *parts, int level, int depth, found_t *found, void *context) {
+    part_t *part = &parts[level];
+    int last = (level + 1 == depth);
+    int count = 0;
+
+    /* literal parts select at most one child */
+    if (part->is_static) {
+        int child = find_child(dispatcher, node, part->name, part->name_len,
+                               child_hash(node, part->name, part->name_len));
+        if (child == NO_NODE) return 0;
+        return last ? invoke_found(dispatcher, child, found, context)
+                    : walk(dispatcher, child, parts, level + 1, depth, found, context);
+    }
+
+    int child;
+    for (child = dispatcher->nodes[node].first_child; child != NO_NODE; child = dispatcher->nodes[child].next_sibling) {
+        if (!osc_pattern_match(&part->pattern, dispatcher->nodes[child].name)) continue;
+        count += last ? invoke_found(dispatcher, child, found, context)
+                      : walk(dispatcher, child, parts, level + 1, depth, found, context);
+    }
+
+    return count;
+}
+
+static int dispatch_pattern(osc_dispatcher_t *dispatcher, const char *address, found_t *found, void *context) {
+    unsigned char   program[OSC_PATTERN_PROGRAM_MAX(OSC_DISPATCH_MAX_PATTERN)];
+    part_t          parts[OSC_DISPATCH_MAX_DEPTH];
+    int             program_len = 0;
+    int             depth = 0;
+
+    if (strlen(address) > OSC_DISPATCH_MAX_PATTERN) return -1;
+
+    const char *p = address;
+    while (*p) {
+        if (depth == OSC_DISPATCH_MAX_DEPTH) return -1;
+        part_t *part = &parts[depth++];
+
+        part->name = ++p;
+        part->is_static = 1;
+        while (*p && *p != '/') {
+            if (*p == '?' || *p == '*' || *p == '{' || *p == '[') part->is_static = 0;
+            p++;
+        }
+        part->name_len = p - part->name;
+
+        if (!part->is_static) {
+            if (!osc_pattern_compile_part(&part->pattern, part->name, part->name_len,
+                                          program + program_len, sizeof(program) - program_len)) {
+                return -1;
+            }
+            program_len += part->pattern.program_len;
+        }
+    }
+
+    return walk(dispatcher, 0, parts, 0, depth, found, context);
+}
+
+static osc_dispatch_cache_entry_t *find_cached(osc_dispatcher_t *dispatcher, const char *address, uint32_t hash) {
+    osc_dispatch_cache_entry_t *entry = &dispatcher->cache[hash & dispatcher->cache_mask];
+    if (entry->generation != dispatcher->generation || entry->hash != hash
+        || strcmp(entry->address, address) != 0) return NULL;
+    return entry;
+}
+
+static int dispatch_cached(osc_dispatcher_t *dispatcher, osc_dispatch_cache_entry_t *entry, void *context) {
+    int i;
+    dispatcher->cache_hits++;
+    for (i = 0; i < entry->n_methods; i++) invoke(&dispatcher->nodes[entry->methods[i]], context);
+    return entry->n_methods;
+}
+
+/* dispatch a verified pattern, caching the methods it resolves to */
+static int dispatch_and_cache(osc_dispatcher_t *dispatcher, const char *address, uint32_t hash, void *context) {
+    if (!dispatcher->cache) return dispatch_pattern(dispatcher, address, NULL, context);
+
+    dispatcher->cache_misses++;
+
+    /* methods may add routes, which must leave this result stale */
+    uint32_t generation = dispatcher->generation;
+    int nodes[OSC_DISPATCH_CACHE_MAX_METHODS];
+    found_t found = { nodes, OSC_DISPATCH_CACHE_MAX_METHODS, 0 };
+
+    int count = dispatch_pattern(dispatcher, address, &found, context);
+    int len = strlen(address);
+    if (count < 0 || found.count > found.max || len >= OSC_DISPATCH_CACHE_MAX_ADDRESS) return count;
+
+    osc_dispatch_cache_entry_t *entry = &dispatcher->cache[hash & dispatcher->cache_mask];
+    entry->hash = hash;
+    entry->generation = generation;
+    entry->n_methods = found.count;
+    memcpy(entry->methods, nodes, found.count * sizeof(int));
+    memcpy(entry->address, address, len + 1);
+    return count;
+}
+
+int osc_dispatch(osc_dispatcher_t *dispatcher, const char *address, void *context) {
+    int type = osc_pattern_verify(address);
+    if (type == OSC_PATTERN_INVALID) return -1;
+    if (type == OSC_PATTERN_STATIC) return dispatch_static(dispatcher, address, context);
+    if (!dispatcher->cache) return dispatch_pattern(dispatcher, address, NULL, context);
+
+    uint32_t hash = osc_address_hash(address);
+    osc_dispatch_cache_entry_t *entry = find_cached(dispatcher, address, hash);
+    return entry ? dispatch_cached(dispatcher, entry, context)
+                 : dispatch_and_cache(dispatcher, address, hash, context);
+}
+
+int osc_dispatch_hashed(osc_dispatcher_t *dispatcher, const char *address, uint32_t hash, void *context) {
+    if (dispatcher->slots) {
+        int node = find_indexed(dispatcher, address, hash);
+        if (node != NO_NODE) return invoke(&dispatcher->nodes[node], context);
+    }
+
+    /* only verified patterns are ever cached */
+    if (dispatcher->cache) {
+        osc_dispatch_cache_entry_t *entry = find_cached(dispatcher, address, hash);
+        if (entry) return dispatch_cached(dispatcher, entry, context);
+    }
+
+    int type = osc_pattern_verify(address);
+    if (type == OSC_PATTERN_INVALID) return -1;
+    if (type == OSC_PATTERN_STATIC) {
+        /* every method is indexed, so a literal address that missed has none */
+        return dispatcher->slots ? 0 : dispatch_static(dispatcher, address, context);
+    }
+    return dispatch_and_cache(dispatcher, address, hash, context);
+}
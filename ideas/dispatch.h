@@ -0,0 +1,191 @@
+#ifndef OSC_DISPATCH_H
+#define OSC_DISPATCH_H
+
+/*
+ * OSC address space and message dispatch.
+ *
+ * Methods are registered at literal addresses and stored in a trie keyed by
+ * address part, so an incoming address is routed by walking one level per
+ * part rather than by comparing it against every method. Each step finds the
+ * child by hashing (parent, part) into a table that shares the node array, so
+ * it costs the same however many siblings there are. Incoming addresses
+ * may be patterns (see pattern.h); subtrees whose container names can't match
+ * the corresponding part of the pattern are never visited.
+ *
+ * Literal incoming addresses - the common case - can instead be routed through
+ * an optional hash index over the registered methods, keyed by the address
+ * hash that `osc_msg_reader_init()` computes while scanning the address. A
+ * hit costs one table probe and one string comparison.
+ *
+ * Patterns that arrive repeatedly - e.g. a fader wildcard sent every frame -
+ * can be served from an optional cache that maps the exact incoming pattern to
+ * the methods it resolved to. Every change to the routes bumps a generation
+ * counter, which invalidates all cached results at once.
+ *
+ * The dispatcher does not allocate: trie nodes and index slots come from
+ * caller-provided arrays, and registered addresses are *not* copied.
+ */
+
+#include <stdint.h>
+
+#ifndef OSC_DISPATCH_MAX_DEPTH
+#define OSC_DISPATCH_MAX_DEPTH      16
+#endif
+
+/* longest incoming pattern that can be dispatched (static addresses are unlimited) */
+#ifndef OSC_DISPATCH_MAX_PATTERN
+#define OSC_DISPATCH_MAX_PATTERN    256
+#endif
+
+/* longest incoming pattern, and largest number of methods, a cache entry can hold */
+#ifndef OSC_DISPATCH_CACHE_MAX_ADDRESS
+#define OSC_DISPATCH_CACHE_MAX_ADDRESS  64
+#endif
+
+#ifndef OSC_DISPATCH_CACHE_MAX_METHODS
+#define OSC_DISPATCH_CACHE_MAX_METHODS  64
+#endif
+
+/*
+ * method callback
+ *
+ * @param address - the address the method was registered at
+ * @param context - the context passed to `osc_dispatch()`, e.g. a message reader
+ * @param userdata - the userdata the method was registered with
+ */
+typedef void (*osc_method_fn)(const char *address, void *context, void *userdata);
+
+typedef struct osc_dispatch_node {
+    const char          *name;          /* points into the registered address */
+    int                 name_len;
+    int                 parent;
+    int                 first_child;
+    int                 last_child;
+    int                 next_sibling;
+    int                 bucket;         /* first node in the child table bucket numbered after this node */
+    int                 next_in_bucket;
+    const char          *address;       /* NULL unless this node is a method */
+    osc_method_fn       method;
+    void                *userdata;
+} osc_dispatch_node_t;
+
+typedef struct osc_dispatch_slot {
+    uint32_t            hash;
+    int                 node;           /* -1 if the slot is empty */
+} osc_dispatch_slot_t;
+
+typedef struct osc_dispatch_cache_entry {
+    uint32_t            hash;
+    uint32_t            generation;     /* entry is stale unless equal to the dispatcher's */
+    int                 n_methods;
+    int                 methods[OSC_DISPATCH_CACHE_MAX_METHODS];
+    char                address[OSC_DISPATCH_CACHE_MAX_ADDRESS];
+} osc_dispatch_cache_entry_t;
+
+typedef struct osc_dispatcher {
+    osc_dispatch_node_t *nodes;
+    int                 max_nodes;
+    int                 n_nodes;
+    uint32_t            bucket_mask;    /* child table buckets are threaded through `nodes` */
+    osc_dispatch_slot_t *slots;         /* NULL unless indexed */
+    uint32_t            slot_mask;
+    int                 n_indexed;
+    osc_dispatch_cache_entry_t *cache;  /* NULL unless caching */
+    uint32_t            cache_mask;
+    uint32_t            generation;     /* incremented whenever the routes change */
+    unsigned long       cache_hits;
+    unsigned long       cache_misses;
+} osc_dispatcher_t;
+
+/*
+ * Initialise a dispatcher
+ *
+ * @param dispatcher - dispatcher to initialise
+ * @param nodes - storage for trie nodes. one node is used for the root, and one
+ *        for each distinct container or method.
+ * @param max_nodes - number of elements in `nodes`
+ * @return 1 on success, 0 otherwise
+ */
+int osc_dispatcher_init(osc_dispatcher_t *dispatcher, osc_dispatch_node_t *nodes, int max_nodes);
+
+/*
+ * Register a method
+ *
+ * Fails if `address` is not a valid literal address, is already registered,
+ * names an existing container, lies beneath an existing method, or needs more
+ * nodes than remain. A failed add leaves the dispatcher unchanged.
+ *
+ * @param dispatcher - dispatcher
+ * @param address - literal address at which to register the method. this is *not*
+ *        copied so you *must* ensure this pointer remains valid for the lifetime of
+ *        the dispatcher.
+ * @param method - callback
+ * @param userdata - passed to `method`
+ * @return 1 on success, 0 otherwise
+ */
+int osc_dispatcher_add(osc_dispatcher_t *dispatcher, const char *address, osc_method_fn method, void *userdata);
+
+/*
+ * Index the dispatcher's methods by address hash
+ *
+ * Every method registered so far is added to the index, as is every method
+ * registered afterwards; `osc_dispatcher_add()` fails once the index is full.
+ * Lookups probe linearly, so keep the index at most half full.
+ *
+ * @param dispatcher - dispatcher
+ * @param slots - storage for the index
+ * @param n_slots - number of elements in `slots`; must be a power of two, and
+ *        greater than the number of methods
+ * @return 1 on success, 0 otherwise
+ */
+int osc_dispatcher_index(osc_dispatcher_t *dispatcher, osc_dispatch_slot_t *slots, int n_slots);
+
+/*
+ * Cache the methods that incoming patterns resolve to
+ *
+ * The cache is direct-mapped by address hash: each pattern occupies the entry
+ * selected by its hash, replacing whatever was there. Patterns longer than
+ * `OSC_DISPATCH_CACHE_MAX_ADDRESS - 1` characters, or matching more than
+ * `OSC_DISPATCH_CACHE_MAX_METHODS` methods, are never cached. Literal
+ * addresses bypass the cache.
+ *
+ * `dispatcher->cache_hits` and `dispatcher->cache_misses` count the patterns
+ * served from the cache and those that had to be matched against the trie.
+ * Both are reset by this function.
+ *
+ * @param dispatcher - dispatcher
+ * @param entries - storage for the cache
+ * @param n_entries - number of elements in `entries`; must be a power of two
+ * @return 1 on success, 0 otherwise
+ */
+int osc_dispatcher_cache(osc_dispatcher_t *dispatcher, osc_dispatch_cache_entry_t *entries, int n_entries);
+
+/*
+ * Dispatch an incoming address (or address pattern) to every matching method
+ *
+ * @param dispatcher - dispatcher
+ * @param address - incoming address, e.g. from `osc_msg_reader_get_address()`
+ * @param context - passed through to each method
+ * @return number of methods invoked, or -1 if `address` is not a valid address
+ *         pattern (or is too long or deep to dispatch)
+ */
+int osc_dispatch(osc_dispatcher_t *dispatcher, const char *address, void *context);
+
+/*
+ * As `osc_dispatch()`, with the address hash already known
+ *
+ * On an indexed dispatcher, an address that hits the index is dispatched
+ * without being verified or split into parts, as is a pattern that hits the
+ * cache; everything else is handled as by `osc_dispatch()`.
+ *
+ * @param dispatcher - dispatcher
+ * @param address - incoming address
+ * @param hash - `osc_address_hash()` of `address`, e.g. from
+ *        `osc_msg_reader_get_address_hash()`
+ * @param context - passed through to each method
+ * @return number of methods invoked, or -1 if `address` is not a valid address
+ *         pattern (or is too long or deep to dispatch)
+ */
+int osc_dispatch_hashed(osc_dispatcher_t *dispatcher, const char *address, uint32_t hash, void *context);
+
+#endif
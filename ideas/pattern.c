@@ -2,7 +2,7 @@
 
 #include <string.h>
 
-static int do_pattern_match(const char *pattern, const char *input);
+static int run_program(const unsigned char *program, const char *input);
 
 /* Public Interface */
 
@@ -26,7 +26,14 @@ int osc_pattern_verify(const char *pattern) {
             slash = p;
         } else if (*p == '[') {
             has_meta = 1;
-            return OSC_PATTERN_INVALID; /* unsupported */
+            p++;
+            if (*p == '!') p++;
+            if (*p == ']') return OSC_PATTERN_INVALID;
+            while (*p && *p != ']') {
+                if (*p == '/') return OSC_PATTERN_INVALID;
+                p++;
+            }
+            if (!*p) return OSC_PATTERN_INVALID;
         } else if (*p == '{') {
             has_meta = 1;
             p++;
@@ -60,99 +67,573 @@ int osc_pattern_verify(const char *pattern) {
             : (has_meta ? OSC_PATTERN_DYNAMIC : OSC_PATTERN_STATIC);
 }
 
-int osc_pattern_compile(osc_pattern_t *pattern_out, const char *pattern_in) {
-    int result = osc_pattern_verify(pattern_in);
-    if (!result) {
-        return 0;
-    } else {
-        pattern_out->is_static = (result == OSC_PATTERN_STATIC);
-        pattern_out->pattern = pattern_in;
-        return 1;
+/*
+ * Compiled programs
+ *
+ * A program is a flat sequence of ops terminated by OP_END (or, for programs
+ * matching a single part, OP_END_PART):
+ *
+ *   OP_SLASH                               '/' starting a part that begins with '*'
+ *   OP_LIT, n, <n bytes>                   literal run
+ *   OP_ANY                                 '?'
+ *   OP_STAR                                '*'
+ *   OP_STAR_PART                           '*' ending a part
+ *   OP_CLASS, <32 bytes>                   '[...]' as a 256-bit membership bitmap
+ *   OP_ALT, count, table length (u16),     '{...}' alternation (or OP_ALT_BACKTRACK,
+ *       count * (n, <n bytes>)             see below)
+ *
+ * u16 values are stored little-endian. All other '/'s are folded into the
+ * surrounding literal runs: verified patterns have no empty parts, and every
+ * op other than '*' consumes at least one non-'/' character, so only a part
+ * starting with '*' needs an explicit check that the input part is not empty.
+ * Literals are compared against the input directly, without first finding the
+ * end of the input part; only '*' needs to know where that is.
+ *
+ * If no alternative of an alternation is a prefix of another, at most one of
+ * them can match at any position, so the matcher takes the first that does
+ * and never revisits the choice. Otherwise the op is OP_ALT_BACKTRACK and
+ * each matching alternative is tried against the rest of the program in turn.
+ */
+
+enum {
+    OP_END              = 0,
+    OP_SLASH            = 1,
+    OP_LIT              = 2,
+    OP_ANY              = 3,
+    OP_STAR             = 4,
+    OP_ALT              = 5,
+    OP_ALT_BACKTRACK    = 6,
+    OP_STAR_PART        = 7,
+    OP_END_PART         = 8,
+    OP_CLASS            = 9
+};
+
+#define ALT_HEADER_LEN      4
+#define CLASS_LEN           33
+
+#define BIT_SET(map, c)     ((map)[(c) >> 3] |= (1 << ((c) & 7)))
+#define BIT_CLEAR(map, c)   ((map)[(c) >> 3] &= ~(1 << ((c) & 7)))
+#define BIT_TEST(map, c)    ((map)[(c) >> 3] & (1 << ((c) & 7)))
+
+typedef struct {
+    unsigned char   *buffer;
+    int             len;
+    int             pos;
+} emitter_t;
+
+static int emit(emitter_t *e, int byte) {
+    if (e->pos == e->len) return 0;
+    e->buffer[e->pos++] = (unsigned char)byte;
+    return 1;
+}
+
+static int emit_bytes(emitter_t *e, const char *bytes, int n) {
+    if (e->len - e->pos < n) return 0;
+    memcpy(e->buffer + e->pos, bytes, n);
+    e->pos += n;
+    return 1;
+}
+
+static void put16(unsigned char *dst, int val) {
+    dst[0] = val & 0xFF;
+    dst[1] = (val >> 8) & 0xFF;
+}
+
+static int get16(const unsigned char *src) {
+    return src[0] | (src[1] << 8);
+}
+
+/* is any alternative in the table a prefix of another? */
+static int alts_overlap(const unsigned char *table, int count) {
+    const unsigned char *a, *b;
+    int i, j;
+    for (i = 0, a = table; i < count; i++, a += 1 + *a) {
+        for (j = 0, b = table; j < count; j++, b += 1 + *b) {
+            if (i != j && *a <= *b && memcmp(a + 1, b + 1, *a) == 0) return 1;
+        }
     }
+    return 0;
+}
+
+/* compile the verified pattern text [p, end) */
+static int compile_program(emitter_t *e, const char *p, const char *end, int end_op) {
+    while (p < end) {
+        if (*p == '/' && p + 1 < end && *(p + 1) == '*') {
+            if (!emit(e, OP_SLASH)) return 0;
+            p++;
+        } else if (*p == '?') {
+            if (!emit(e, OP_ANY)) return 0;
+            p++;
+        } else if (*p == '*') {
+            /* consecutive stars are equivalent to one */
+            while (p < end && *p == '*') p++;
+            /* a star ending a part simply consumes the rest of it */
+            if (!emit(e, (p == end || *p == '/') ? OP_STAR_PART : OP_STAR)) return 0;
+        } else if (*p == '[') {
+            if (e->len - e->pos < CLASS_LEN) return 0;
+            unsigned char *map = e->buffer + e->pos + 1;
+            memset(map, 0, CLASS_LEN - 1);
+            p++;
+            int negate = (*p == '!');
+            if (negate) p++;
+            while (*p != ']') {
+                int lo = (unsigned char)*p, hi = lo;
+                /* a '-' that ends the class is literal */
+                if (*(p + 1) == '-' && *(p + 2) != ']') {
+                    hi = (unsigned char)*(p + 2);
+                    p += 3;
+                } else {
+                    p++;
+                }
+                for (; lo <= hi; lo++) BIT_SET(map, lo);
+            }
+            p++;
+            if (negate) {
+                int i;
+                for (i = 0; i < CLASS_LEN - 1; i++) map[i] = ~map[i];
+            }
+            /* a class never matches past the end of a part */
+            BIT_CLEAR(map, '\0');
+            BIT_CLEAR(map, '/');
+            e->buffer[e->pos] = OP_CLASS;
+            e->pos += CLASS_LEN;
+        } else if (*p == '{') {
+            int alt = e->pos;
+            if (e->len - e->pos < ALT_HEADER_LEN) return 0;
+            e->pos += ALT_HEADER_LEN;
+            int count = 0;
+            p++;
+            while (1) {
+                const char *start = p;
+                while (*p != ',' && *p != '}') p++;
+                int n = p - start;
+                if (n > 255 || count == 255) return 0;
+                if (!emit(e, n) || !emit_bytes(e, start, n)) return 0;
+                count++;
+                if (*(p++) == '}') break;
+            }
+            int table_len = e->pos - (alt + ALT_HEADER_LEN);
+            if (table_len > 0xFFFF) return 0;
+            e->buffer[alt] = alts_overlap(e->buffer + alt + ALT_HEADER_LEN, count) ? OP_ALT_BACKTRACK : OP_ALT;
+            e->buffer[alt + 1] = count;
+            put16(e->buffer + alt + 2, table_len);
+        } else {
+            const char *start = p++;
+            while (p < end && !(*p == '/' && p + 1 < end && *(p + 1) == '*')
+                   && *p != '?' && *p != '*' && *p != '{' && *p != '[') p++;
+            int remain = p - start;
+            while (remain > 0) {
+                int n = remain > 255 ? 255 : remain;
+                if (!emit(e, OP_LIT) || !emit(e, n) || !emit_bytes(e, start, n)) return 0;
+                start += n;
+                remain -= n;
+            }
+        }
+    }
+    return emit(e, end_op);
+}
+
+int osc_pattern_compile(osc_pattern_t *pattern_out, const char *pattern_in, void *buffer, int len) {
+    int result = osc_pattern_verify(pattern_in);
+    if (!result) return 0;
+    
+    emitter_t e = { (unsigned char*)buffer, len, 0 };
+    if (!compile_program(&e, pattern_in, pattern_in + strlen(pattern_in), OP_END)) return 0;
+    
+    pattern_out->is_static = (result == OSC_PATTERN_STATIC);
+    pattern_out->pattern = pattern_in;
+    pattern_out->program = e.buffer;
+    pattern_out->program_len = e.pos;
+    return 1;
+}
+
+int osc_pattern_compile_part(osc_pattern_t *pattern_out, const char *part, int part_len, void *buffer, int len) {
+    emitter_t e = { (unsigned char*)buffer, len, 0 };
+    if (!compile_program(&e, part, part + part_len, OP_END_PART)) return 0;
+    
+    /* parts are always matched by their program */
+    pattern_out->is_static = 0;
+    pattern_out->pattern = part;
+    pattern_out->program = e.buffer;
+    pattern_out->program_len = e.pos;
+    return 1;
 }
 
 int osc_pattern_match(osc_pattern_t *pattern, const char *input) {
     if (pattern->is_static) {
         return strcmp(pattern->pattern, input) == 0;
     } else {
-        return do_pattern_match(pattern->pattern, input);
+        return run_program(pattern->program, input);
     }
 }
 
 /* ... */
 
-static int do_pattern_match(const char *pattern, const char *input) {
-    if (*input != '/') return 0;
-    
-    const char  *p      = pattern + 1,
-                *i      = input + 1,
-                *slash  = input;
-                
-    while (*p && *i) {
-        
-        if (*i == '/') {
-            if (i - slash == 1) return 0;
-            slash = i;
-            if (*p == '*') p++;
-            if (*p != '/') return 0;
-            p++; i++;
-            continue;
-        }
-        
-        switch (*p) {
-            case '?':
-                if (*i == '/') {
-                    return 0;
-                } else {
-                    p++; i++;
-                    continue;
-                }
-            case '*':
+/* does the input at `i` start with the `n` bytes of `lit`? */
+static int has_prefix(const char *i, const unsigned char *lit, int n) {
+    while (n--) {
+        if (*(i++) != (char)*(lit++)) return 0;
+    }
+    return 1;
+}
+
+static int run_program(const unsigned char *pc, const char *i) {
+    while (1) {
+        switch (*pc) {
+            case OP_END:
+                return *i == '\0';
+            case OP_END_PART:
+                return *i == '/' || *i == '\0';
+            case OP_SLASH:
+                if (*i != '/') return 0;
+                i++;
+                /* parts are never empty */
+                if (*i == '/' || *i == '\0') return 0;
+                pc++;
+                break;
+            case OP_LIT:
+            {
+                int n = pc[1];
+                if (!has_prefix(i, pc + 2, n)) return 0;
+                i += n;
+                pc += 2 + n;
+                break;
+            }
+            case OP_ANY:
+                if (*i == '/' || *i == '\0') return 0;
+                i++;
+                pc++;
+                break;
+            case OP_CLASS:
+                if (!BIT_TEST(pc + 1, (unsigned char)*i)) return 0;
+                i++;
+                pc += CLASS_LEN;
+                break;
+            case OP_STAR_PART:
                 while (*i && *i != '/') i++;
-                p++;
-                continue;
-            case '[':
+                pc++;
+                break;
+            case OP_STAR:
+            {
+                const char *end = i;
+                while (*end && *end != '/') end++;
+                pc++;
+                for (; i <= end; i++) {
+                    if (run_program(pc, i)) return 1;
+                }
                 return 0;
-            case '{':
+            }
+            case OP_ALT:
             {
-                const char *mark = i;
-                
-                p++;
-                while (1) {
-                    if (*p == *i) {
-                        p++; i++;
-                        if (*p == ',') {
-                            p++;
-                            while ((*p) != '}') p++;
-                            p++;
-                            break;
-                        } else if (*p == '}') {
-                            p++;
-                            break;
-                        }
-                    } else {
-                        i = mark;
-                        while (*p != ',' && *p != '}') p++;
-                        if (*p == ',') {
-                            p++;
-                        } else {
-                            return 0;
-                        }
-                    }
+                int count = pc[1];
+                const unsigned char *alt = pc + ALT_HEADER_LEN;
+                while (count && !has_prefix(i, alt + 1, *alt)) {
+                    alt += 1 + *alt;
+                    count--;
                 }
-                continue;
+                if (!count) return 0;
+                i += *alt;
+                pc += ALT_HEADER_LEN + get16(pc + 2);
+                break;
             }
-            default:
-                if (*p != *i) {
-                    return 0;
-                } else {
-                    p++; i++;
-                    continue;
+            case OP_ALT_BACKTRACK:
+            {
+                int count = pc[1];
+                const unsigned char *alt = pc + ALT_HEADER_LEN;
+                const unsigned char *next = alt + get16(pc + 2);
+                while (count--) {
+                    if (has_prefix(i, alt + 1, *alt) && run_program(next, i + *alt)) return 1;
+                    alt += 1 + *alt;
                 }
+                return 0;
+            }
+            default:
+                return 0;
         }
     }
-    
-    if (*p == '*') p++;
-    
-    return !(*p) && !(*i);
+}
+
+/* Pattern sets */
+
+enum {
+    PART_STATIC         = 0,
+    PART_ANY            = 1,    /* nothing but '*'s; matches any part */
+    PART_PROGRAM        = 2
+};
+
+#define NO_PART             -1
+
+#define FNV_OFFSET          2166136261u
+#define FNV_PRIME           16777619u
+
+typedef struct osc_pattern_set_part {
+    const char          *text;
+    const unsigned char *program;   /* PART_PROGRAM only */
+    int                 len;
+    int                 depth;
+    uint32_t            hash;
+    int                 kind;
+    int                 next;       /* next non-static part at the same depth */
+} set_part_t;
+
+static uint32_t hash_part(const char *text, int len, int depth) {
+    uint32_t hash = FNV_OFFSET;
+    while (len--) hash = (hash ^ (unsigned char)*(text++)) * FNV_PRIME;
+    return (hash ^ depth) * FNV_PRIME;
+}
+
+static int n_set_slots(int max_parts) {
+    int n = 1;
+    while (n < 2 * max_parts) n <<= 1;
+    return n;
+}
+
+static uint64_t *part_bits(osc_pattern_set_t *set, int part) {
+    return set->bits + part * set->words;
+}
+
+/* bitset of patterns with `depth` parts */
+static uint64_t *depth_bits(osc_pattern_set_t *set, int depth) {
+    return set->bits + (set->max_parts + depth - 1) * set->words;
+}
+
+static int find_part(osc_pattern_set_t *set, const char *text, int len, int depth, uint32_t hash) {
+    uint32_t i = hash & set->slot_mask;
+    int part;
+    while ((part = set->slots[i]) != NO_PART) {
+        set_part_t *p = &set->parts[part];
+        if (p->hash == hash && p->len == len && p->depth == depth && memcmp(p->text, text, len) == 0) break;
+        i = (i + 1) & set->slot_mask;
+    }
+    return part;
+}
+
+static int add_part(osc_pattern_set_t *set, const char *text, int len, int depth, uint32_t hash, int kind) {
+    if (set->n_parts == set->max_parts) return NO_PART;
+
+    int part = set->n_parts;
+    set_part_t *p = &set->parts[part];
+    p->text = text;
+    p->program = NULL;
+    p->len = len;
+    p->depth = depth;
+    p->hash = hash;
+    p->kind = kind;
+    p->next = NO_PART;
+
+    if (kind == PART_PROGRAM) {
+        osc_pattern_t compiled;
+        if (!osc_pattern_compile_part(&compiled, text, len, set->programs + set->programs_pos,
+                                      set->programs_len - set->programs_pos)) {
+            return NO_PART;
+        }
+        p->program = compiled.program;
+        set->programs_pos += compiled.program_len;
+    }
+
+    if (kind != PART_STATIC) {
+        p->next = set->first_dynamic[depth];
+        set->first_dynamic[depth] = part;
+    }
+
+    uint32_t i = hash & set->slot_mask;
+    while (set->slots[i] != NO_PART) i = (i + 1) & set->slot_mask;
+    set->slots[i] = part;
+    set->n_parts++;
+    return part;
+}
+
+static int no_matches(uint64_t *matches, int words) {
+    memset(matches, 0, words * sizeof(uint64_t));
+    return 0;
+}
+
+int osc_pattern_set_size(int max_patterns, int max_parts) {
+    int words = (max_patterns + 63) / 64;
+    /* one bitset per part, one per depth, and one of scratch */
+    return (max_parts + OSC_PATTERN_SET_MAX_DEPTH + 1) * words * sizeof(uint64_t)
+            + max_parts * sizeof(set_part_t)
+            + n_set_slots(max_parts) * sizeof(int);
+}
+
+int osc_pattern_set_init(osc_pattern_set_t *set, int max_patterns, int max_parts, void *buffer, int len) {
+    if (max_patterns < 1 || max_parts < 1) return 0;
+
+    int size = osc_pattern_set_size(max_patterns, max_parts);
+    if (len < size) return 0;
+
+    int words = (max_patterns + 63) / 64;
+    int bitsets = max_parts + OSC_PATTERN_SET_MAX_DEPTH + 1;
+    int n_slots = n_set_slots(max_parts);
+    int i;
+
+    set->max_patterns = max_patterns;
+    set->n_patterns = 0;
+    set->words = words;
+    set->bits = (uint64_t*)buffer;
+    memset(set->bits, 0, bitsets * words * sizeof(uint64_t));
+    set->parts = (set_part_t*)(set->bits + bitsets * words);
+    set->max_parts = max_parts;
+    set->n_parts = 0;
+    set->slots = (int*)(set->parts + max_parts);
+    for (i = 0; i < n_slots; i++) set->slots[i] = NO_PART;
+    set->slot_mask = n_slots - 1;
+    set->programs = (unsigned char*)buffer + size;
+    set->programs_len = len - size;
+    set->programs_pos = 0;
+    for (i = 0; i < OSC_PATTERN_SET_MAX_DEPTH; i++) set->first_dynamic[i] = NO_PART;
+
+    return 1;
+}
+
+/* record pattern `id` against the part with the given text, adding it if need be */
+static int set_part_bit(osc_pattern_set_t *set, const char *text, int len, int depth, int kind, int id) {
+    uint32_t hash = hash_part(text, len, depth);
+    int part = find_part(set, text, len, depth, hash);
+    if (part == NO_PART) {
+        part = add_part(set, text, len, depth, hash, kind);
+        if (part == NO_PART) return 0;
+    }
+    part_bits(set, part)[id >> 6] |= 1ull << (id & 63);
+    return 1;
+}
+
+/*
+ * a part whose only metacharacters are a single '{...}' is equivalent to one
+ * literal part per alternative, which is found by hash lookup rather than by
+ * running a program. the expanded text is stored with the compiled programs.
+ */
+static int set_expanded_bits(osc_pattern_set_t *set, const char *text, int len, int depth, int id) {
+    const char *open = text, *close;
+    while (*open != '{') open++;
+    for (close = open; *close != '}'; close++);
+
+    int prefix_len = open - text;
+    int suffix_len = text + len - (close + 1);
+    const char *alt = open + 1;
+
+    while (alt < close) {
+        const char *alt_end = alt;
+        while (*alt_end != ',' && *alt_end != '}') alt_end++;
+        int alt_len = alt_end - alt;
+        int n = prefix_len + alt_len + suffix_len;
+        if (set->programs_len - set->programs_pos < n) return 0;
+
+        char *expanded = (char*)set->programs + set->programs_pos;
+        memcpy(expanded, text, prefix_len);
+        memcpy(expanded + prefix_len, alt, alt_len);
+        memcpy(expanded + prefix_len + alt_len, close + 1, suffix_len);
+
+        /* keep the text only if it became a new part */
+        int n_parts = set->n_parts;
+        if (!set_part_bit(set, expanded, n, depth, PART_STATIC, id)) return 0;
+        if (set->n_parts != n_parts) set->programs_pos += n;
+
+        alt = alt_end + 1;
+    }
+    return 1;
+}
+
+int osc_pattern_set_add(osc_pattern_set_t *set, const char *pattern) {
+    if (set->n_patterns == set->max_patterns) return -1;
+    if (osc_pattern_verify(pattern) == OSC_PATTERN_INVALID) return -1;
+
+    const char *p;
+    int depth = 0;
+    for (p = pattern; *p; p++) {
+        if (*p == '/') depth++;
+    }
+    if (depth > OSC_PATTERN_SET_MAX_DEPTH) return -1;
+
+    int id = set->n_patterns;
+
+    depth = 0;
+    p = pattern;
+    while (*p) {
+        const char *text = ++p;
+        int braces = 0, other_meta = 0, all_star = 1;
+        while (*p && *p != '/') {
+            if (*p == '{') braces++;
+            if (*p == '?' || *p == '*' || *p == '[') other_meta = 1;
+            if (*p != '*') all_star = 0;
+            p++;
+        }
+        int len = p - text;
+
+        int ok;
+        if (all_star) {
+            ok = set_part_bit(set, text, len, depth, PART_ANY, id);
+        } else if (braces == 1 && !other_meta) {
+            ok = set_expanded_bits(set, text, len, depth, id);
+        } else {
+            ok = set_part_bit(set, text, len, depth, (braces || other_meta) ? PART_PROGRAM : PART_STATIC, id);
+        }
+        if (!ok) {
+            /* the next add reuses this ID, so it must not be left on any part */
+            int part;
+            for (part = 0; part < set->n_parts; part++) {
+                part_bits(set, part)[id >> 6] &= ~(1ull << (id & 63));
+            }
+            return -1;
+        }
+        depth++;
+    }
+
+    depth_bits(set, depth)[id >> 6] |= 1ull << (id & 63);
+    set->n_patterns++;
+    return id;
+}
+
+int osc_pattern_set_match(osc_pattern_set_t *set, const char *input, uint64_t *matches) {
+    int words = set->words;
+    uint64_t *seg = set->bits + (set->max_parts + OSC_PATTERN_SET_MAX_DEPTH) * words;
+    int depth = 0, i;
+
+    if (*input != '/') return no_matches(matches, words);
+    for (i = 0; i < words; i++) matches[i] = ~0ull;
+
+    const char *p = input;
+    while (*p) {
+        if (depth == OSC_PATTERN_SET_MAX_DEPTH) return no_matches(matches, words);
+
+        /* hash the part while finding its end */
+        const char *text = ++p;
+        uint32_t hash = FNV_OFFSET;
+        while (*p && *p != '/') hash = (hash ^ (unsigned char)*(p++)) * FNV_PRIME;
+        int len = p - text;
+        if (!len) return no_matches(matches, words);
+        hash = (hash ^ depth) * FNV_PRIME;
+
+        memset(seg, 0, words * sizeof(uint64_t));
+        int part = find_part(set, text, len, depth, hash);
+        if (part != NO_PART && set->parts[part].kind == PART_STATIC) {
+            uint64_t *bits = part_bits(set, part);
+            for (i = 0; i < words; i++) seg[i] |= bits[i];
+        }
+        for (part = set->first_dynamic[depth]; part != NO_PART; part = set->parts[part].next) {
+            set_part_t *dyn = &set->parts[part];
+            if (dyn->kind == PART_PROGRAM && !run_program(dyn->program, text)) continue;
+            uint64_t *bits = part_bits(set, part);
+            for (i = 0; i < words; i++) seg[i] |= bits[i];
+        }
+
+        uint64_t any = 0;
+        for (i = 0; i < words; i++) {
+            matches[i] &= seg[i];
+            any |= matches[i];
+        }
+        if (!any) return 0;
+        depth++;
+    }
+
+    uint64_t *bits = depth_bits(set, depth);
+    int count = 0;
+    for (i = 0; i < words; i++) {
+        uint64_t w = (matches[i] &= bits[i]);
+        while (w) {
+            w &= w - 1;
+            count++;
+        }
+    }
+    return count;
 }
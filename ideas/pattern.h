@@ -1,16 +1,18 @@
-#ifndef OSC_H
-#define OSC_H
+#ifndef OSC_PATTERN_H
+#define OSC_PATTERN_H
 
 /*
  * OSC pattern-matching routines based on 'OSC Message Dispatching and Pattern Matching',
  * (http://opensoundcontrol.org/spec-1_0)
- *
- * Character ranges (e.g. [abc], [!abc], [a-z], [!a-z]) are currently unsupported.
  */
 
+#include <stdint.h>
+
 typedef struct osc_pattern {
-    int         is_static;
-    const char  *pattern;
+    int                 is_static;
+    const char          *pattern;
+    unsigned char       *program;
+    int                 program_len;
 } osc_pattern_t;
 
 enum {
@@ -19,15 +21,23 @@ enum {
     OSC_PATTERN_DYNAMIC         = 2
 };
 
+/*
+ * Upper bound on the size of the program compiled from a pattern of
+ * `pattern_len` characters. character classes dominate: each compiles to a
+ * 33 byte op, and may be as short as 3 characters.
+ */
+#define OSC_PATTERN_PROGRAM_MAX(pattern_len) (11 * (pattern_len) + 1)
+
 /*
  * Verify that a pattern string is valid. The following rules are enforced:
  *
  * - leading slash
- * - no trailing slash 
+ * - no trailing slash
  * - no empty parts
  * - no illegal characters (#)
  * - no unmatched brackets and braces
  * - no nested braces
+ * - no empty character classes, and no '/' within them
  *
  * @param pattern - pattern string to verify
  * @return 1 if pattern is valid, 0 otherwise
@@ -37,24 +47,143 @@ int osc_pattern_verify(const char *pattern);
 /*
  * Compile a pattern
  *
- * For now this function simply scans the pattern for metacharacters, allowing
- * `osc_pattern_match()` to use a simple `strcmp()` in static cases. In the future
- * compilation maybe be
+ * Static patterns (those without metacharacters) are matched with a simple
+ * `strcmp()`. Dynamic patterns are compiled to a program - address part
+ * boundaries, literal runs with precomputed lengths, '?'/'*' ops, alternation
+ * tables and character class bitmaps - which `osc_pattern_match()` executes
+ * without re-parsing the pattern.
  *
  * @param pattern_out - an `osc_pattern_t` in which to store compiled pattern
  * @param pattern_in - pattern string. this is *not* copied so you *must* ensure this pointer
  *        remains valid for the lifetime of the compiled pattern.
+ * @param buffer - buffer in which to store the compiled program; must remain valid
+ *        for the lifetime of the compiled pattern. `OSC_PATTERN_PROGRAM_MAX(strlen(pattern_in))`
+ *        bytes are always sufficient.
+ * @param len - size of `buffer`
  * @return 1 if pattern was compiled successfully, 0 otherwise
  */
-int osc_pattern_compile(osc_pattern_t *pattern_out, const char *pattern_in);
+int osc_pattern_compile(osc_pattern_t *pattern_out, const char *pattern_in, void *buffer, int len);
+
+/*
+ * Compile a single part of a pattern
+ *
+ * The resulting program matches one address part - text terminated by '/' or
+ * NUL - which lets callers such as the dispatcher match an address one part at
+ * a time.
+ *
+ * @param pattern_out - an `osc_pattern_t` in which to store compiled part
+ * @param part - start of the part, without its leading '/'; the part must be taken
+ *        from a pattern that passed `osc_pattern_verify()`
+ * @param part_len - length of the part
+ * @param buffer - buffer in which to store the compiled program; `OSC_PATTERN_PROGRAM_MAX(part_len)`
+ *        bytes are always sufficient.
+ * @param len - size of `buffer`
+ * @return 1 if the part was compiled successfully, 0 otherwise
+ */
+int osc_pattern_compile_part(osc_pattern_t *pattern_out, const char *part, int part_len, void *buffer, int len);
 
 /*
  * Match a string against a pattern
  *
  * @param pattern - an `osc_pattern_t` to match against
- * @param input - string to match 
+ * @param input - string to match; for patterns compiled with `osc_pattern_compile_part()`,
+ *        a single part terminated by '/' or NUL
  * @return 1 if string matches pattern, 0 otherwise
  */
 int osc_pattern_match(osc_pattern_t *pattern, const char *input);
 
-#endif
\ No newline at end of file
+/*
+ * Pattern sets
+ *
+ * A pattern set matches one address against many patterns at once, e.g. the
+ * subscriptions of a relay. Since no OSC 1.0 wildcard spans a '/', a pattern
+ * matches an address exactly when each of its parts matches the address part
+ * at the same depth and the two have the same number of parts. The set
+ * therefore keeps a bitset of pattern IDs for each distinct (depth, part) pair
+ * and for each depth count, and matching ANDs together, per address part, the
+ * union of the bitsets whose parts match it.
+ *
+ * Literal parts are found by a single hash lookup. A part whose only
+ * metacharacters are one '{...}' is stored as one literal part per
+ * alternative, and parts consisting only of '*' match without being run, so
+ * the per-part cost is one lookup plus one program run for each *distinct*
+ * remaining dynamic part at that depth. Bitset operations cover 64 patterns
+ * per word.
+ */
+
+#ifndef OSC_PATTERN_SET_MAX_DEPTH
+#define OSC_PATTERN_SET_MAX_DEPTH   16
+#endif
+
+struct osc_pattern_set_part;
+
+typedef struct osc_pattern_set {
+    int                 max_patterns;
+    int                 n_patterns;
+    int                 words;              /* uint64_t words per bitset */
+    uint64_t            *bits;
+    struct osc_pattern_set_part *parts;
+    int                 max_parts;
+    int                 n_parts;
+    int                 *slots;
+    uint32_t            slot_mask;
+    unsigned char       *programs;
+    int                 programs_len;
+    int                 programs_pos;
+    int                 first_dynamic[OSC_PATTERN_SET_MAX_DEPTH];
+} osc_pattern_set_t;
+
+/*
+ * Number of bytes of buffer a pattern set needs for its tables, excluding
+ * compiled programs
+ *
+ * @param max_patterns - maximum number of patterns
+ * @param max_parts - maximum number of distinct (depth, part) pairs across all patterns
+ * @return size in bytes
+ */
+int osc_pattern_set_size(int max_patterns, int max_parts);
+
+/*
+ * Initialise an empty pattern set
+ *
+ * @param set - set to initialise
+ * @param max_patterns - maximum number of patterns
+ * @param max_parts - maximum number of distinct (depth, part) pairs across all patterns
+ * @param buffer - storage for the set, aligned for `uint64_t`. the first
+ *        `osc_pattern_set_size(max_patterns, max_parts)` bytes hold its tables and
+ *        the remainder holds compiled dynamic parts and expanded alternatives.
+ * @param len - size of `buffer`
+ * @return 1 on success, 0 otherwise
+ */
+int osc_pattern_set_init(osc_pattern_set_t *set, int max_patterns, int max_parts, void *buffer, int len);
+
+/*
+ * Add a pattern to a set
+ *
+ * Fails if the pattern is invalid, deeper than `OSC_PATTERN_SET_MAX_DEPTH`, or
+ * the set is full. A failed add leaves the set's matches unchanged, but may
+ * still use up space for parts.
+ *
+ * @param set - pattern set
+ * @param pattern - pattern string. this is *not* copied so you *must* ensure this pointer
+ *        remains valid for the lifetime of the set.
+ * @return the pattern's ID (IDs are assigned in order from 0), or -1 on failure
+ */
+int osc_pattern_set_add(osc_pattern_set_t *set, const char *pattern);
+
+/*
+ * Match an address against every pattern in a set, in a single pass over the
+ * address
+ *
+ * Uses scratch space within the set, so a set must not be matched from
+ * several threads at once.
+ *
+ * @param set - pattern set
+ * @param input - address to match
+ * @param matches - receives a bitset of matching pattern IDs (bit `id % 64`
+ *        of word `id / 64`); must hold `set->words` words
+ * @return number of matching patterns
+ */
+int osc_pattern_set_match(osc_pattern_set_t *set, const char *input, uint64_t *matches);
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "queue.h"
+#include "wheel.h"
+
+// Compares the heap and the timing wheel under the classic "hold" model: N
+// messages are pending, and simulated time advances in 1 ms steps; every
+// message that falls due is removed and rescheduled up to 10 s later, so the
+// number pending stays at N. Also checks that neither releases a message
+// early, or more than one tick late.
+
+#define TICK_USEC       1000
+#define HORIZON_USEC    10000000
+#define OPS             2000000
+
+static uint32_t rng = 12345;
+
+static long random_delay(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return 1 + rng % HORIZON_USEC;
+}
+
+static void add_usec(osc_time_t *t, long usec) {
+    usec += t->tv_usec;
+    t->tv_sec += usec / 1000000;
+    t->tv_usec = usec % 1000000;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// was `msg` released outside the tick in which it fell due?
+static int is_mistimed(osc_msg_t *msg, osc_time_t now) {
+    struct timeval late;
+    OSC_TIME_DIFF(msg->due, now, &late);
+    return late.tv_sec != 0 || late.tv_usec >= TICK_USEC;
+}
+
+static void fill(osc_msg_t *msgs, int n, osc_time_t *start) {
+    int i;
+    rng = 12345;
+    for (i = 0; i < n; i++) {
+        msgs[i].due = *start;
+        add_usec(&msgs[i].due, random_delay());
+        msgs[i].value = i;
+    }
+}
+
+static double bench_heap(osc_msg_t *msgs, int n, osc_time_t start, int *errors) {
+    osc_msg_queue_t queue;
+    osc_msg_queue_init(&queue, n, 0);
+    fill(msgs, n, &start);
+    
+    int i, ops = 0;
+    for (i = 0; i < n; i++) {
+        osc_msg_queue_add(&queue, &msgs[i]);
+    }
+    
+    osc_time_t now = start;
+    double t0 = now_s();
+    while (ops < OPS) {
+        add_usec(&now, TICK_USEC);
+        while (OSC_TIME_CMP(queue.heap[0].msg->due, <=, now)) {
+            osc_msg_t *msg = osc_msg_queue_remove(&queue);
+            *errors += is_mistimed(msg, now);
+            msg->due = now;
+            add_usec(&msg->due, random_delay());
+            osc_msg_queue_add(&queue, msg);
+            ops++;
+        }
+    }
+    double elapsed = now_s() - t0;
+    
+    osc_msg_queue_teardown(&queue);
+    return elapsed * 1e9 / ops;
+}
+
+static double bench_wheel(osc_msg_t *msgs, int n, osc_time_t start, int *errors) {
+    static osc_msg_wheel_t wheel;
+    osc_msg_wheel_init(&wheel, TICK_USEC, &start);
+    fill(msgs, n, &start);
+    
+    int i, ops = 0;
+    for (i = 0; i < n; i++) {
+        osc_msg_wheel_add(&wheel, &msgs[i]);
+    }
+    
+    osc_time_t now = start;
+    double t0 = now_s();
+    while (ops < OPS) {
+        add_usec(&now, TICK_USEC);
+        osc_msg_t *msg;
+        while ((msg = osc_msg_wheel_remove_due(&wheel, &now))) {
+            *errors += is_mistimed(msg, now);
+            msg->due = now;
+            add_usec(&msg->due, random_delay());
+            osc_msg_wheel_add(&wheel, msg);
+            ops++;
+        }
+    }
+    double elapsed = now_s() - t0;
+    
+    if (osc_msg_wheel_size(&wheel) != (size_t)n) {
+        (*errors)++;
+    }
+    return elapsed * 1e9 / ops;
+}
+
+int main(int argc, char *argv[]) {
+    static const int sizes[] = { 1000, 100000, 1000000 };
+    osc_msg_t *msgs = malloc(sizeof(osc_msg_t) * 1000000);
+    osc_time_t start = { 1000, 0 };
+    int i;
+    
+    printf("%10s %14s %14s\n", "pending", "heap ns/op", "wheel ns/op");
+    for (i = 0; i < 3; i++) {
+        int heap_errors = 0, wheel_errors = 0;
+        double heap = bench_heap(msgs, sizes[i], start, &heap_errors);
+        double wheel = bench_wheel(msgs, sizes[i], start, &wheel_errors);
+        printf("%10d %14.1f %14.1f%s%s\n", sizes[i], heap, wheel,
+               heap_errors ? "  HEAP ERRORS" : "", wheel_errors ? "  WHEEL ERRORS" : "");
+    }
+    
+    free(msgs);
+    return 0;
+}
@@ -31,7 +31,10 @@ void* consume(void *userdata) {
     osc_msg_queue_t *queue = (osc_msg_queue_t*)userdata;
     while (1) {
         osc_msg_t *msg = osc_msg_queue_take_due_s(queue, NULL);
-        printf("taken: %d\n", (int) msg->value);
+        OSC_TIME_MK_NOW(now);
+        struct timeval late;
+        OSC_TIME_DIFF(msg->due, now, &late);
+        printf("taken: %d (%ld us late)\n", (int) msg->value, (long) (late.tv_sec * 1000000 + late.tv_usec));
         fflush(stdout);
     }
 }
@@ -41,6 +44,11 @@ int main(int argc, char *argv[]) {
     osc_msg_queue_t queue;
     osc_msg_queue_init(&queue, 32, OSC_QUEUE_GROWABLE);
     
+    // optional argument: busy-wait for the last N microseconds before items are due
+    if (argc > 1) {
+        osc_msg_queue_set_spin(&queue, atol(argv[1]));
+    }
+    
     pthread_attr_t thread_attr;
     pthread_attr_init(&thread_attr);
     pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_JOINABLE);
@@ -1,36 +1,78 @@
 #include "queue.h"
 
 #include <sched.h>
+#include <string.h>
 
 // some thoughts on yielding:
 // http://www.technovelty.org/code/c/sched_yield.html
 
-#define HEAP_PARENT(ix)         ((ix-1)/2)
-#define HEAP_LEFT_IX(ix)        ((2*ix)+1)
-#define HEAP_RIGHT_IX(ix)       ((2*ix)+2)
+// the heap is 4-ary: a node's children are adjacent, and HEAP_PAD unused
+// entries before the root align each group of siblings to a cache line.
+#define HEAP_ARITY              4
+#define HEAP_PAD                (HEAP_ARITY - 1)
+#define HEAP_ALIGN              (HEAP_ARITY * sizeof(osc_msg_heap_entry_t))
+#define HEAP_PARENT(ix)         (((ix) - 1) / HEAP_ARITY)
+#define HEAP_FIRST_CHILD(ix)    ((HEAP_ARITY * (ix)) + 1)
+// microseconds fit in 20 bits, so this orders keys as the timevals they came from
+#define HEAP_KEY(t)             (((uint64_t)(t).tv_sec << 20) | (uint64_t)(t).tv_usec)
 #define HEAP_MSG_P(i)           ((i)->due)
-#define HEAP_P(q, ix)           (HEAP_MSG_P(q->heap[ix]))
 #define HEAP_SIZE(q)            (q->c_items)
-#define HEAP_ROOT(q)            (q->heap[0])
+#define HEAP_ROOT(q)            (q->heap[0].msg)
 
 #define LOCK(q)                 (pthread_mutex_lock(&q->lock))
 #define UNLOCK(q)               (pthread_mutex_unlock(&q->lock))
 
+#define TIMESPEC_BEFORE(t1, t2) (((t1).tv_sec == (t2).tv_sec) ?     \
+                                 ((t1).tv_nsec < (t2).tv_nsec) :    \
+                                 ((t1).tv_sec < (t2).tv_sec))
+
+static osc_msg_heap_entry_t* _osc_heap_alloc(size_t n_items) {
+    void *mem;
+    if (posix_memalign(&mem, HEAP_ALIGN, sizeof(osc_msg_heap_entry_t) * (n_items + HEAP_PAD)) != 0) {
+        return NULL;
+    }
+    return (osc_msg_heap_entry_t*)mem + HEAP_PAD;
+}
+
+static void _osc_heap_free(osc_msg_heap_entry_t *heap) {
+    free(heap - HEAP_PAD);
+}
+
 int osc_msg_queue_init(osc_msg_queue_t *queue, int initial_capacity, int flags) {
-    queue->heap = malloc(sizeof(osc_msg_t) * initial_capacity);
+    if (initial_capacity < 1) {
+        initial_capacity = 1;
+    }
+    queue->heap = _osc_heap_alloc(initial_capacity);
     if (!queue->heap) {
         return 0;
     }
     queue->n_items = initial_capacity;
     queue->c_items = 0;
     queue->flags = flags;
+    queue->head_seq = 0;
+    queue->spin_usec = 0;
+    queue->spinning = 0;
     pthread_mutex_init(&queue->lock, NULL);
-    pthread_cond_init(&queue->cond, NULL);
+    
+    // deadlines are monotonic so that they're unaffected by clock changes
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    
     return 1;
 }
 
+void osc_msg_queue_set_spin(osc_msg_queue_t *queue, long spin_usec) {
+    LOCK(queue);
+    queue->spin_usec = spin_usec;
+    UNLOCK(queue);
+}
+
 int osc_msg_queue_teardown(osc_msg_queue_t *queue) {
-    if (queue->heap) free(queue->heap);
+    if (queue->heap) _osc_heap_free(queue->heap);
+    queue->heap = NULL;
     return 1;
 }
 
@@ -47,27 +89,32 @@ int osc_msg_queue_add(osc_msg_queue_t *queue, osc_msg_t *msg) {
         if (!(queue->flags & OSC_QUEUE_GROWABLE)) {
             return 0;
         }
-        queue->n_items *= 2;
-        queue->heap = realloc(queue->heap, sizeof(osc_msg_t) * queue->n_items);
-        if (!queue->heap) {
-            queue->n_items /= 2;
+        osc_msg_heap_entry_t *heap = _osc_heap_alloc(queue->n_items * 2);
+        if (!heap) {
             return 0;
         }
+        memcpy(heap, queue->heap, sizeof(osc_msg_heap_entry_t) * queue->c_items);
+        _osc_heap_free(queue->heap);
+        queue->heap = heap;
+        queue->n_items *= 2;
     }
     
-    size_t ix       = queue->c_items++;
-    size_t parent   = HEAP_PARENT(ix);
-    
-    queue->heap[ix] = msg;
+    size_t      ix  = queue->c_items++;
+    uint64_t    key = HEAP_KEY(msg->due);
     
-    while ((ix > 0) && OSC_TIME_CMP(HEAP_P(queue, parent), >, HEAP_MSG_P(msg))) {
-        osc_msg_t *tmp = queue->heap[parent];
-        queue->heap[parent] = queue->heap[ix];
-        queue->heap[ix] = tmp;
+    // move parents down into the hole until the new entry fits
+    while (ix > 0) {
+        size_t parent = HEAP_PARENT(ix);
+        if (queue->heap[parent].key <= key) {
+            break;
+        }
+        queue->heap[ix] = queue->heap[parent];
         ix = parent;
-        parent = HEAP_PARENT(ix);
     }
     
+    queue->heap[ix].key = key;
+    queue->heap[ix].msg = msg;
+    
     return 1;
     
 }
@@ -79,37 +126,34 @@ osc_msg_t* osc_msg_queue_remove(osc_msg_queue_t *queue) {
     }
     
     osc_msg_t *out = HEAP_ROOT(queue);
-    queue->heap[0] = queue->heap[--queue->c_items];
-    
-    int ix = 0;
+    osc_msg_heap_entry_t last = queue->heap[--queue->c_items];
+    size_t size = HEAP_SIZE(queue);
+    size_t ix = 0;
     
+    // move the smallest child up into the hole until the last entry fits
     while (1) {
-        size_t  left_ix     = HEAP_LEFT_IX(ix),
-                right_ix    = HEAP_RIGHT_IX(ix),
-                smallest_ix = ix;
-
-        if (left_ix < HEAP_SIZE(queue) && OSC_TIME_CMP(HEAP_P(queue, left_ix),
-                                                       <,
-                                                       HEAP_P(queue, smallest_ix))) {
-            smallest_ix = left_ix;
+        size_t first = HEAP_FIRST_CHILD(ix);
+        if (first >= size) {
+            break;
         }
-
-        if (right_ix < HEAP_SIZE(queue) && OSC_TIME_CMP(HEAP_P(queue, right_ix),
-                                                        <,
-                                                        HEAP_P(queue, smallest_ix))) {
-            smallest_ix = right_ix;
+        
+        size_t end = (first + HEAP_ARITY < size) ? (first + HEAP_ARITY) : size;
+        size_t smallest = first, child;
+        for (child = first + 1; child < end; child++) {
+            if (queue->heap[child].key < queue->heap[smallest].key) {
+                smallest = child;
+            }
         }
-
-        if (smallest_ix != ix) {
-            osc_msg_t *tmp = queue->heap[ix];
-            queue->heap[ix] = queue->heap[smallest_ix];
-            queue->heap[smallest_ix] = tmp;
-            ix = smallest_ix;
-        } else {
+        
+        if (queue->heap[smallest].key >= last.key) {
             break;
         }
+        queue->heap[ix] = queue->heap[smallest];
+        ix = smallest;
     }
     
+    queue->heap[ix] = last;
+    
     return out;
 
 }
@@ -130,9 +174,10 @@ void osc_msg_queue_unlock(osc_msg_queue_t *queue) {
 
 int osc_msg_queue_add_s(osc_msg_queue_t *queue, osc_msg_t *msg) {
     LOCK(queue);
-    int was_empty = (HEAP_SIZE(queue) == 0);
     int ret = osc_msg_queue_add(queue, msg);
-    if (ret && was_empty) {
+    // a new head is due sooner than anything consumers are waiting for
+    if (ret && HEAP_ROOT(queue) == msg) {
+        __atomic_store_n(&queue->head_seq, queue->head_seq + 1, __ATOMIC_RELEASE);
         pthread_cond_signal(&queue->cond);
     }
     UNLOCK(queue);
@@ -187,35 +232,65 @@ osc_msg_t* osc_msg_queue_take_s(osc_msg_queue_t *queue) {
     return msg;
 }
 
+// monotonic time at which `msg` becomes due, given `threshold`
+static void _osc_msg_deadline(osc_msg_t *msg, struct timeval *threshold, struct timespec *now, struct timespec *out) {
+    struct timeval diff;
+    OSC_TIME_MK_NOW(wall);
+    clock_gettime(CLOCK_MONOTONIC, now);
+    OSC_TIME_DIFF(wall, HEAP_MSG_P(msg), &diff);
+    if (threshold != NULL) {
+        OSC_TIMEVAL_DIFF(threshold, &diff, &diff);
+    }
+    out->tv_sec = now->tv_sec + diff.tv_sec;
+    out->tv_nsec = now->tv_nsec + diff.tv_usec * 1000;
+    if (out->tv_nsec >= 1000000000) {
+        out->tv_sec++;
+        out->tv_nsec -= 1000000000;
+    }
+}
+
 osc_msg_t* osc_msg_queue_take_due_s(osc_msg_queue_t *queue, struct timeval *threshold) {
     osc_msg_t *msg = NULL;
     LOCK(queue);
     while (1) {
         if (HEAP_SIZE(queue) == 0) {
             pthread_cond_wait(&queue->cond, &queue->lock);
+            continue;
+        }
+        
+        struct timespec now, deadline;
+        _osc_msg_deadline(HEAP_ROOT(queue), threshold, &now, &deadline);
+        if (!TIMESPEC_BEFORE(now, deadline)) {
+            msg = osc_msg_queue_remove(queue);
+            break;
+        }
+        
+        if (queue->spin_usec <= 0 || queue->spinning) {
+            pthread_cond_timedwait(&queue->cond, &queue->lock, &deadline);
+            continue;
+        }
+        
+        struct timespec spin_from = deadline;
+        spin_from.tv_sec -= queue->spin_usec / 1000000;
+        spin_from.tv_nsec -= (queue->spin_usec % 1000000) * 1000;
+        if (spin_from.tv_nsec < 0) {
+            spin_from.tv_sec--;
+            spin_from.tv_nsec += 1000000000;
+        }
+        
+        if (TIMESPEC_BEFORE(now, spin_from)) {
+            pthread_cond_timedwait(&queue->cond, &queue->lock, &spin_from);
         } else {
-            struct timeval diff;
-            if (_osc_is_msg_due(HEAP_ROOT(queue), threshold, &diff)) {
-                msg = osc_msg_queue_remove(queue);
-                break;
-            } else {
-                // TODO: need to replace this with some better time-control
-                //sched_yield();
-                
-                UNLOCK(queue);
-                usleep(1000); // 1ms
-                LOCK(queue);
-                
-                // if (threshold == NULL) {
-                //     UNLOCK(queue);
-                //     // sleep for the min of (diff, queue max sleep time)
-                //     LOCK(queue);
-                // } else {
-                //     UNLOCK(queue);
-                //     // 
-                //     LOCK(queue);
-                // }
-            }
+            // spin without the lock, watching for adds that change the head
+            unsigned int seq = queue->head_seq;
+            queue->spinning = 1;
+            UNLOCK(queue);
+            do {
+                clock_gettime(CLOCK_MONOTONIC, &now);
+            } while (TIMESPEC_BEFORE(now, deadline)
+                     && __atomic_load_n(&queue->head_seq, __ATOMIC_ACQUIRE) == seq);
+            LOCK(queue);
+            queue->spinning = 0;
         }
     }
     UNLOCK(queue);
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <time.h>
+#include <sys/time.h>
 
 //
 // compute difference (t2 - t1) of two `struct timeval *` and store in `out`.
@@ -27,7 +28,7 @@
 
 typedef struct timeval osc_time_t;
 
-#define OSC_TIME_SET_NOW(var)       gettimeofday(&var)
+#define OSC_TIME_SET_NOW(var)       gettimeofday(&var, NULL)
 
 // create a named variable containing the current time on the stack
 #define OSC_TIME_MK_NOW(var)        osc_time_t var; \
@@ -52,15 +53,26 @@ typedef struct timeval osc_time_t;
 typedef struct osc_msg {
     osc_time_t      due;
     int             value;
+    struct osc_msg  *next;          // used by osc_msg_wheel_t
 } osc_msg_t;
 
+// heap entries carry a copy of the message's due time, packed into an integer
+// so that ordering entries needs neither a dereference nor a timeval compare
+typedef struct osc_msg_heap_entry {
+    uint64_t            key;
+    osc_msg_t           *msg;
+} osc_msg_heap_entry_t;
+
 typedef struct osc_msg_queue {
-    osc_msg_t           **heap;
+    osc_msg_heap_entry_t *heap;
     size_t              n_items;
     size_t              c_items;
     int                 flags;
     pthread_mutex_t     lock;
-    pthread_cond_t      cond;
+    pthread_cond_t      cond;           // uses CLOCK_MONOTONIC
+    unsigned int        head_seq;       // incremented whenever an add changes the head
+    long                spin_usec;
+    int                 spinning;       // a consumer is busy-waiting for the head
 } osc_msg_queue_t;
 
 enum {
@@ -70,6 +82,13 @@ enum {
 int         osc_msg_queue_init(osc_msg_queue_t *queue, int initial_capacity, int flags);
 int         osc_msg_queue_teardown(osc_msg_queue_t *queue);
 
+// by default, osc_msg_queue_take_due_s() sleeps until the head is due. with a
+// non-zero `spin_usec` it sleeps until `spin_usec` before then and busy-waits
+// the rest of the way, trading CPU for wakeup accuracy (sleeps typically
+// overshoot by tens of microseconds). only one consumer spins at a time; any
+// others sleep until the deadline.
+void        osc_msg_queue_set_spin(osc_msg_queue_t *queue, long spin_usec);
+
 //
 // 
 
@@ -98,7 +117,9 @@ osc_msg_t*  osc_msg_queue_remove_due_s(osc_msg_queue_t *queue, struct timeval *t
 // wait for item to become available, then return it
 osc_msg_t*  osc_msg_queue_take_s(osc_msg_queue_t *queue);
 
-// wait for item to become both available and due, then return it
+// wait for item to become both available and due, then return it.
+// waits until the head's due time (less `threshold`), or until an add changes
+// the head.
 osc_msg_t*  osc_msg_queue_take_due_s(osc_msg_queue_t *queue, struct timeval *threshold);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "wheel.h"
+
+#include <string.h>
+
+#define WHEEL_MASK              (OSC_WHEEL_SLOTS - 1)
+#define WHEEL_SPAN(level)       ((uint64_t)1 << (OSC_WHEEL_BITS * (level)))
+
+#define SLOT_SET(w, ix)         ((w)->occupied[(ix) >> 6] |= (1ull << ((ix) & 63)))
+#define SLOT_CLEAR(w, ix)       ((w)->occupied[(ix) >> 6] &= ~(1ull << ((ix) & 63)))
+
+// number of whole ticks from the origin to `t`, rounded up or down
+static uint64_t _osc_wheel_ticks(osc_msg_wheel_t *wheel, osc_time_t *t, int round_up) {
+    struct timeval diff;
+    OSC_TIME_DIFF(wheel->origin, *t, &diff);
+    if (diff.tv_sec < 0) {
+        return 0;
+    }
+    uint64_t usec = (uint64_t)diff.tv_sec * 1000000 + diff.tv_usec;
+    if (round_up) {
+        usec += wheel->tick_usec - 1;
+    }
+    return usec / wheel->tick_usec;
+}
+
+// file a message in the slot for its due tick, relative to the current tick
+static void _osc_wheel_place(osc_msg_wheel_t *wheel, osc_msg_t *msg) {
+    uint64_t expires = _osc_wheel_ticks(wheel, &msg->due, 1);
+    if (expires < wheel->now_tick) {
+        expires = wheel->now_tick;
+    }
+    
+    uint64_t delta = expires - wheel->now_tick;
+    if (delta >= WHEEL_SPAN(OSC_WHEEL_LEVELS)) {
+        delta = WHEEL_SPAN(OSC_WHEEL_LEVELS) - 1;
+        expires = wheel->now_tick + delta;
+    }
+    
+    int level = 0;
+    while (delta >= WHEEL_SPAN(level + 1)) {
+        level++;
+    }
+    
+    int ix = (expires >> (OSC_WHEEL_BITS * level)) & WHEEL_MASK;
+    osc_msg_wheel_slot_t *slot = &wheel->slots[level][ix];
+    
+    msg->next = NULL;
+    if (slot->tail) {
+        slot->tail->next = msg;
+    } else {
+        slot->head = msg;
+    }
+    slot->tail = msg;
+    
+    if (level == 0) {
+        SLOT_SET(wheel, ix);
+    }
+}
+
+// move the messages in each higher-level slot that has come round down a level.
+// called whenever the current tick crosses a level 0 boundary.
+static void _osc_wheel_cascade(osc_msg_wheel_t *wheel) {
+    int level;
+    for (level = 1; level < OSC_WHEEL_LEVELS; level++) {
+        int ix = (wheel->now_tick >> (OSC_WHEEL_BITS * level)) & WHEEL_MASK;
+        osc_msg_t *msg = wheel->slots[level][ix].head;
+        wheel->slots[level][ix].head = NULL;
+        wheel->slots[level][ix].tail = NULL;
+        while (msg) {
+            osc_msg_t *next = msg->next;
+            _osc_wheel_place(wheel, msg);
+            msg = next;
+        }
+        // only continue upwards if this level has wrapped too
+        if (ix != 0) {
+            break;
+        }
+    }
+}
+
+// index of the first non-empty level 0 slot at or after `from`, or -1
+static int _osc_wheel_next_occupied(osc_msg_wheel_t *wheel, int from) {
+    int w = from >> 6;
+    if (w >= OSC_WHEEL_SLOTS / 64) {
+        return -1;
+    }
+    uint64_t bits = wheel->occupied[w] & (~0ull << (from & 63));
+    while (!bits) {
+        if (++w == OSC_WHEEL_SLOTS / 64) {
+            return -1;
+        }
+        bits = wheel->occupied[w];
+    }
+    return (w << 6) + __builtin_ctzll(bits);
+}
+
+int osc_msg_wheel_init(osc_msg_wheel_t *wheel, long tick_usec, osc_time_t *origin) {
+    if (tick_usec <= 0) {
+        return 0;
+    }
+    if (origin) {
+        wheel->origin = *origin;
+    } else {
+        OSC_TIME_SET_NOW(wheel->origin);
+    }
+    wheel->tick_usec = tick_usec;
+    wheel->now_tick = 0;
+    wheel->c_items = 0;
+    memset(wheel->slots, 0, sizeof(wheel->slots));
+    memset(wheel->occupied, 0, sizeof(wheel->occupied));
+    return 1;
+}
+
+size_t osc_msg_wheel_size(osc_msg_wheel_t *wheel) {
+    return wheel->c_items;
+}
+
+int osc_msg_wheel_add(osc_msg_wheel_t *wheel, osc_msg_t *msg) {
+    _osc_wheel_place(wheel, msg);
+    wheel->c_items++;
+    return 1;
+}
+
+osc_msg_t* osc_msg_wheel_remove_due(osc_msg_wheel_t *wheel, osc_time_t *now) {
+    uint64_t target;
+    if (now) {
+        target = _osc_wheel_ticks(wheel, now, 0);
+    } else {
+        OSC_TIME_MK_NOW(t);
+        target = _osc_wheel_ticks(wheel, &t, 0);
+    }
+    
+    // nothing to cascade, so time can simply jump forwards
+    if (wheel->c_items == 0) {
+        if (target > wheel->now_tick) {
+            wheel->now_tick = target;
+        }
+        return NULL;
+    }
+    
+    while (1) {
+        int ix = wheel->now_tick & WHEEL_MASK;
+        osc_msg_wheel_slot_t *slot = &wheel->slots[0][ix];
+        
+        if (slot->head) {
+            osc_msg_t *msg = slot->head;
+            slot->head = msg->next;
+            if (!slot->head) {
+                slot->tail = NULL;
+                SLOT_CLEAR(wheel, ix);
+            }
+            wheel->c_items--;
+            return msg;
+        }
+        
+        if (wheel->now_tick >= target) {
+            return NULL;
+        }
+        
+        // skip empty slots in this round of level 0...
+        int next = _osc_wheel_next_occupied(wheel, ix + 1);
+        if (next >= 0) {
+            uint64_t tick = (wheel->now_tick & ~(uint64_t)WHEEL_MASK) + next;
+            wheel->now_tick = (tick < target) ? tick : target;
+            continue;
+        }
+        
+        // ...and, if there are none left, move on to the next round
+        uint64_t round_end = (wheel->now_tick | WHEEL_MASK) + 1;
+        if (round_end > target) {
+            wheel->now_tick = target;
+            continue;
+        }
+        wheel->now_tick = round_end;
+        _osc_wheel_cascade(wheel);
+    }
+}
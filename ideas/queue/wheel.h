@@ -0,0 +1,58 @@
+#ifndef __WHEEL_H__
+#define __WHEEL_H__
+
+#include "queue.h"
+
+//
+// Hierarchical timing wheel
+//
+// An alternative to the heap in osc_msg_queue_t for large numbers of pending
+// messages. Time is divided into ticks of a configurable length, and a message
+// is stored in the slot for the tick it falls due in: level 0 has one slot per
+// tick for the next OSC_WHEEL_SLOTS ticks, and each level above covers
+// OSC_WHEEL_SLOTS times the span of the one below at correspondingly coarser
+// resolution. Messages are moved ("cascaded") down a level as their slot comes
+// round, so insertion is O(1) and expiry amortised O(1), against O(log n) for
+// both with the heap.
+//
+// Due times are rounded up to a tick boundary, so messages are never released
+// early, and at most one tick late (plus however long the caller takes to
+// poll). Messages falling due in the same tick are released in the order they
+// reached level 0, not strictly in order of due time. Messages more than
+// OSC_WHEEL_SLOTS ^ OSC_WHEEL_LEVELS ticks away are parked in the top level and
+// re-filed when it comes round.
+//
+// Messages are linked through their `next` field; the wheel does not allocate.
+// Not thread-safe.
+
+#define OSC_WHEEL_BITS          8
+#define OSC_WHEEL_SLOTS         (1 << OSC_WHEEL_BITS)
+#define OSC_WHEEL_LEVELS        4
+
+typedef struct osc_msg_wheel_slot {
+    osc_msg_t           *head;
+    osc_msg_t           *tail;
+} osc_msg_wheel_slot_t;
+
+typedef struct osc_msg_wheel {
+    osc_time_t              origin;         // start of tick 0
+    long                    tick_usec;
+    uint64_t                now_tick;       // ticks up to and including this have been released
+    size_t                  c_items;
+    osc_msg_wheel_slot_t    slots[OSC_WHEEL_LEVELS][OSC_WHEEL_SLOTS];
+    uint64_t                occupied[OSC_WHEEL_SLOTS / 64];     // non-empty level 0 slots
+} osc_msg_wheel_t;
+
+// `tick_usec` is the wheel's resolution; `origin` is the time of tick 0, or
+// NULL for the current time. messages due before `origin` are released
+// immediately.
+int         osc_msg_wheel_init(osc_msg_wheel_t *wheel, long tick_usec, osc_time_t *origin);
+
+size_t      osc_msg_wheel_size(osc_msg_wheel_t *wheel);
+int         osc_msg_wheel_add(osc_msg_wheel_t *wheel, osc_msg_t *msg);
+
+// remove and return a message that is due at `now` (NULL for the current
+// time), or NULL if there is none. `now` must not move backwards.
+osc_msg_t*  osc_msg_wheel_remove_due(osc_msg_wheel_t *wheel, osc_time_t *now);
+
+#endif
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "dispatch.h"
+#include "little-oscar/osc.h"
+
+osc_dispatch_node_t nodes[8192];
+osc_dispatch_slot_t slots[8192];
+osc_dispatch_cache_entry_t cache[16];
+osc_dispatcher_t dispatcher;
+
+int calls;
+
+void count_call(const char *address, void *context, void *userdata) {
+    calls++;
+}
+
+void should_dispatch(const char *address, int expected) {
+    calls = 0;
+    int result = osc_dispatch(&dispatcher, address, NULL);
+    if (result == expected && calls == (expected < 0 ? 0 : expected)) {
+        printf("[ OK ] `%s` dispatched to %d method(s)\n", address, expected);
+    } else {
+        printf("[FAIL] `%s` dispatched to %d method(s), expected %d\n", address, result, expected);
+    }
+}
+
+void should_dispatch_hashed(const char *address, int expected) {
+    calls = 0;
+    int result = osc_dispatch_hashed(&dispatcher, address, osc_address_hash(address), NULL);
+    if (result == expected && calls == (expected < 0 ? 0 : expected)) {
+        printf("[ OK ] `%s` dispatched to %d method(s) via index\n", address, expected);
+    } else {
+        printf("[FAIL] `%s` dispatched to %d method(s) via index, expected %d\n", address, result, expected);
+    }
+}
+
+void should_have_cached(unsigned long hits, unsigned long misses) {
+    if (dispatcher.cache_hits == hits && dispatcher.cache_misses == misses) {
+        printf("[ OK ] cache hits %lu, misses %lu\n", hits, misses);
+    } else {
+        printf("[FAIL] cache hits %lu, misses %lu, expected %lu, %lu\n",
+               dispatcher.cache_hits, dispatcher.cache_misses, hits, misses);
+    }
+}
+
+void should_add(const char *address, int expected) {
+    if (osc_dispatcher_add(&dispatcher, address, count_call, NULL) == expected) {
+        printf("[ OK ] `%s` %s\n", address, expected ? "registered" : "rejected");
+    } else {
+        printf("[FAIL] `%s` %s\n", address, expected ? "rejected" : "registered");
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    osc_dispatcher_init(&dispatcher, nodes, sizeof(nodes) / sizeof(nodes[0]));
+
+    should_add      ("/mixer/ch1/level",            1);
+    should_add      ("/mixer/ch1/mute",             1);
+    should_add      ("/mixer/ch2/level",            1);
+    should_add      ("/mixer/ch2/mute",             1);
+    should_add      ("/mixer/master/level",         1);
+    should_add      ("/transport/play",             1);
+    should_add      ("/transport/stop",             1);
+
+    should_add      ("/transport/play",             0);
+    should_add      ("/mixer/ch1",                  0);
+    should_add      ("/transport/play/fast",        0);
+    should_add      ("/mixer/*/level",              0);
+    should_add      ("/mixer//level",               0);
+
+    should_dispatch ("/mixer/ch1/level",            1);
+    should_dispatch ("/transport/stop",             1);
+    should_dispatch ("/transport/pause",            0);
+    should_dispatch ("/mixer/ch1",                  0);
+    should_dispatch ("/mixer/ch1/level/x",          0);
+
+    should_dispatch ("/mixer/*/level",              3);
+    should_dispatch ("/mixer/ch?/*",                4);
+    should_dispatch ("/mixer/{ch2,master}/level",   2);
+    should_dispatch ("/*/*",                        2);
+    should_dispatch ("/*/*/*",                      5);
+    should_dispatch ("/transport/{play,stop}",      2);
+    should_dispatch ("/mix*/ch1/mute",              1);
+    should_dispatch ("/*",                          0);
+    should_dispatch ("/mixer/ch[12]/level",         2);
+    should_dispatch ("/mixer/[!c]*/level",          1);
+
+    should_dispatch ("/mixer//level",               -1);
+    should_dispatch ("mixer/ch1/level",             -1);
+
+    osc_dispatcher_index(&dispatcher, slots, 16);
+    should_add      ("/mixer/master/mute",          1);
+    should_add      ("/transport/stop",             0);
+
+    should_dispatch_hashed ("/mixer/ch1/level",     1);
+    should_dispatch_hashed ("/mixer/master/mute",   1);
+    should_dispatch_hashed ("/transport/pause",     0);
+    should_dispatch_hashed ("/mixer/ch1",           0);
+    should_dispatch_hashed ("/mixer/*/mute",        3);
+    should_dispatch_hashed ("/mixer//level",        -1);
+    should_dispatch ("/transport/play",             1);
+    should_dispatch ("/transport/pause",            0);
+
+    osc_dispatcher_cache(&dispatcher, cache, 16);
+    should_dispatch ("/mixer/*/level",              3);
+    should_dispatch_hashed ("/mixer/*/level",       3);
+    should_dispatch ("/mixer/{ch1,ch2}/mute",       2);
+    should_dispatch ("/transport/play",             1);
+    should_dispatch ("/mixer/*/gain",               0);
+    should_dispatch ("/mixer/*/gain",               0);
+    should_dispatch ("/mixer//gain",                -1);
+    should_have_cached (2, 3);
+    should_add      ("/mixer/ch3/level",            1);
+    should_dispatch ("/mixer/*/level",              4);
+    should_dispatch ("/mixer/*/level",              4);
+    should_have_cached (3, 4);
+
+    /* running out of nodes partway down a path must not leave containers behind */
+    osc_dispatcher_init(&dispatcher, nodes, 6);
+    should_add      ("/a/b/c",                      1);
+    should_add      ("/x/y/z",                      0);
+    should_add      ("/x",                          1);
+    should_dispatch ("/*",                          1);
+    should_dispatch ("/*/*/*",                      1);
+    should_add      ("/a/b/d",                      1);
+    should_add      ("/a/e",                        0);
+    should_dispatch ("/a/b/*",                      2);
+
+    //
+    // Quick speed test
+
+    static char addresses[4096][32];
+    int i, n;
+
+    osc_dispatcher_init(&dispatcher, nodes, sizeof(nodes) / sizeof(nodes[0]));
+    for (i = 0; i < 4096; i++) {
+        sprintf(addresses[i], "/track/%d/param/%d", i / 64, i % 64);
+        osc_dispatcher_add(&dispatcher, addresses[i], count_call, NULL);
+    }
+
+    const char *inputs[] = {
+        "/track/12/param/40",
+        "/track/63/param/63",
+        "/track/7/param/{1,2,3}",
+        "/track/*/param/0"
+    };
+
+    for (i = 0; i < 4; i++) {
+        int iterations = (i < 2) ? 1000000 : 100000;
+        calls = 0;
+        clock_t start = clock();
+        for (n = 0; n < iterations; n++) {
+            osc_dispatch(&dispatcher, inputs[i], NULL);
+        }
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("%-24s %.1f ns/dispatch (%d methods each)\n", inputs[i], elapsed * 1e9 / iterations, calls / iterations);
+    }
+
+    /* literal addresses through the index and patterns through the cache,
+     * with the hash the reader would provide */
+    osc_dispatcher_index(&dispatcher, slots, sizeof(slots) / sizeof(slots[0]));
+    osc_dispatcher_cache(&dispatcher, cache, sizeof(cache) / sizeof(cache[0]));
+    for (i = 0; i < 4; i++) {
+        int iterations = 1000000;
+        uint32_t hash = osc_address_hash(inputs[i]);
+        calls = 0;
+        clock_t start = clock();
+        for (n = 0; n < iterations; n++) {
+            osc_dispatch_hashed(&dispatcher, inputs[i], hash, NULL);
+        }
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("%-24s %.1f ns/dispatch (%s)\n", inputs[i], elapsed * 1e9 / iterations, (i < 2) ? "indexed" : "cached");
+    }
+    printf("cache hits %lu, misses %lu\n", dispatcher.cache_hits, dispatcher.cache_misses);
+
+    return 0;
+}
@@ -1,13 +1,16 @@
 #include <stdio.h>
-#include <mach/mach_time.h>
+#include <string.h>
+#include <time.h>
 
 #include "pattern.h"
 
 osc_pattern_t compiled;
+unsigned char program[1024];
 
 void should_not_match(const char *pattern, const char *input) {
-    osc_pattern_compile(&compiled, pattern);
-    if (!osc_pattern_match(&compiled, input)) {
+    if (!osc_pattern_compile(&compiled, pattern, program, sizeof(program))) {
+        printf("[FAIL] pattern `%s` does not compile\n", pattern);
+    } else if (!osc_pattern_match(&compiled, input)) {
         printf("[ OK ] `%s` does not match pattern `%s`\n", input, pattern);
     } else {
         printf("[FAIL] `%s` matches pattern `%s`\n", input, pattern);
@@ -15,14 +18,41 @@ void should_not_match(const char *pattern, const char *input) {
 }
 
 void should_match(const char *pattern, const char *input) {
-    osc_pattern_compile(&compiled, pattern);
-    if (osc_pattern_match(&compiled, input)) {
+    if (!osc_pattern_compile(&compiled, pattern, program, sizeof(program))) {
+        printf("[FAIL] pattern `%s` does not compile\n", pattern);
+    } else if (osc_pattern_match(&compiled, input)) {
         printf("[ OK ] `%s` matches pattern `%s`\n", input, pattern);
     } else {
         printf("[FAIL] `%s` does not match pattern `%s`\n", input, pattern);
     }
 }
 
+void should_be_invalid(const char *pattern) {
+    if (osc_pattern_verify(pattern) == OSC_PATTERN_INVALID
+        && !osc_pattern_compile(&compiled, pattern, program, sizeof(program))) {
+        printf("[ OK ] pattern `%s` is rejected\n", pattern);
+    } else {
+        printf("[FAIL] pattern `%s` is accepted\n", pattern);
+    }
+}
+
+/* the set must agree with matching each of its patterns individually */
+void should_set_match(osc_pattern_set_t *set, osc_pattern_t *patterns, const char *input) {
+    uint64_t matches[4];
+    int count = osc_pattern_set_match(set, input, matches);
+    int i, expected = 0, agree = 1;
+    for (i = 0; i < set->n_patterns; i++) {
+        int match = osc_pattern_match(&patterns[i], input);
+        expected += match;
+        if (match != (int)((matches[i >> 6] >> (i & 63)) & 1)) agree = 0;
+    }
+    if (agree && count == expected) {
+        printf("[ OK ] `%s` matches %d pattern(s) in set\n", input, count);
+    } else {
+        printf("[FAIL] `%s` matches %d pattern(s) in set, expected %d\n", input, count, expected);
+    }
+}
+
 int main(int argc, char *argv) {
     
     should_match    ("/foo",                    "/foo");
@@ -120,16 +150,201 @@ int main(int argc, char *argv) {
     should_match    ("/a{alpha,bravo,delta}*",          "/abravo1");
     
     
+    //
+    // Character classes
+    
+    should_match    ("/[abc]",                  "/a");
+    should_match    ("/[abc]",                  "/c");
+    should_not_match("/[abc]",                  "/d");
+    should_not_match("/[abc]",                  "/ab");
+    should_match    ("/ch[0-9]",                "/ch7");
+    should_not_match("/ch[0-9]",                "/chx");
+    should_match    ("/ch[0-9][0-9]/level",     "/ch42/level");
+    should_match    ("/[!abc]",                 "/d");
+    should_not_match("/[!abc]",                 "/b");
+    should_not_match("/a[!x]b",                 "/a/b");
+    should_match    ("/[a-cx-z]*",              "/yes");
+    should_not_match("/[a-cx-z]*",              "/no");
+    should_match    ("/[-a]",                   "/-");
+    should_match    ("/[a-]",                   "/-");
+    should_match    ("/*[0-9]",                 "/track12");
+    should_not_match("/*[0-9]",                 "/track");
+    
     //
     // Invalid patterns
     
     should_not_match("/*/foo",                  "//foo");
+    should_be_invalid("/[]");
+    should_be_invalid("/[!]");
+    should_be_invalid("/[a");
+    should_be_invalid("/[a/b]");
+    should_be_invalid("/a]");
+    should_be_invalid("/{a,b");
+    should_be_invalid("/{a,{b}}");
+    should_be_invalid("/a/");
+    should_be_invalid("/a//b");
+    should_be_invalid("/a#b");
+    
+    //
+    // Backtracking
     
+    should_match    ("/a*b",                    "/ab");
+    should_match    ("/a*b",                    "/abbb");
+    should_match    ("/a*b",                    "/axbxb");
+    should_not_match("/a*b",                    "/axbx");
+    should_match    ("/*a*",                    "/banana");
+    should_not_match("/*a*",                    "/berry");
+    should_match    ("/{a,ab}c",                "/abc");
+    should_match    ("/{foo,foobar}*/x",        "/foobarbaz/x");
+    should_not_match("/foo/*",                  "/foo/bar/baz");
+    should_not_match("/foo",                    "/foo/bar");
+    should_not_match("/foo/bar",                "/foo");
     
+    //
+    // Pattern sets
+    
+    const char *set_patterns[] = {
+        "/mixer/*/level",
+        "/mixer/ch1/level",
+        "/mixer/{ch1,ch2}/*",
+        "/mixer/ch[0-9]/mute",
+        "/mixer/*",
+        "/*/*/*",
+        "/transport/play",
+        "/transport/p*",
+        "/mixer/**/level",
+        "/fx/rev/param?",
+        "/fx/{rev,dly}/param1",
+        "/transport/{pl,st}{ay,op}"
+    };
+    int n_set = sizeof(set_patterns) / sizeof(set_patterns[0]);
+    static uint64_t set_buffer[1024];
+    osc_pattern_set_t set;
+    osc_pattern_t set_compiled[12];
+    static unsigned char set_programs[12][256];
+    int k;
+    
+    osc_pattern_set_init(&set, 64, 32, set_buffer, sizeof(set_buffer));
+    for (k = 0; k < n_set; k++) {
+        osc_pattern_compile(&set_compiled[k], set_patterns[k], set_programs[k], sizeof(set_programs[k]));
+        if (osc_pattern_set_add(&set, set_patterns[k]) != k) {
+            printf("[FAIL] `%s` not added to set\n", set_patterns[k]);
+        }
+    }
+    if (osc_pattern_set_add(&set, "/mixer//level") == -1) {
+        printf("[ OK ] invalid pattern not added to set\n");
+    } else {
+        printf("[FAIL] invalid pattern added to set\n");
+    }
+    
+    should_set_match(&set, set_compiled, "/mixer/ch1/level");
+    should_set_match(&set, set_compiled, "/mixer/ch2/mute");
+    should_set_match(&set, set_compiled, "/mixer/master/level");
+    should_set_match(&set, set_compiled, "/mixer/master");
+    should_set_match(&set, set_compiled, "/transport/play");
+    should_set_match(&set, set_compiled, "/transport/pause");
+    should_set_match(&set, set_compiled, "/fx/rev/param1");
+    should_set_match(&set, set_compiled, "/fx/rev/param12");
+    should_set_match(&set, set_compiled, "/fx/dly/param1");
+    should_set_match(&set, set_compiled, "/transport/stop");
+    should_set_match(&set, set_compiled, "/mixer//level");
+    should_set_match(&set, set_compiled, "/mixer/ch1/level/");
+    should_set_match(&set, set_compiled, "mixer/ch1/level");
+    should_set_match(&set, set_compiled, "/a/b/c/d");
+    
+    /* adds that run out of parts must not leave their ID behind for the next add */
+    osc_pattern_set_t small;
+    static uint64_t small_buffer[256];
+    uint64_t small_matches[1];
+    osc_pattern_set_init(&small, 64, 4, small_buffer, sizeof(small_buffer));
+    int small_ids[4] = {
+        osc_pattern_set_add(&small, "/x/y/z"),
+        osc_pattern_set_add(&small, "/a/y/q"),
+        osc_pattern_set_add(&small, "/x/y/w"),
+        osc_pattern_set_add(&small, "/x/y/z")
+    };
+    int small_count = osc_pattern_set_match(&small, "/a/y/z", small_matches);
+    if (small_ids[0] == 0 && small_ids[1] == -1 && small_ids[2] == -1 && small_ids[3] == 1
+        && small_count == 0 && small_matches[0] == 0
+        && osc_pattern_set_match(&small, "/x/y/z", small_matches) == 2) {
+        printf("[ OK ] failed adds leave no matches behind\n");
+    } else {
+        printf("[FAIL] failed adds leave matches behind (`/a/y/z` matched %d)\n", small_count);
+    }
+    
+    //
     // Quick speed test
     
+    const char *patterns[] = {
+        "/mixer/*/level",
+        "/mixer/{ch1,ch2,ch3,ch4}/mute",
+        "/fx/???/param*",
+        "/transport/play"
+    };
+    const char *inputs[] = {
+        "/mixer/ch12/level",
+        "/mixer/ch3/mute",
+        "/fx/rev/param12",
+        "/transport/stop"
+    };
     
+    osc_pattern_t compiled_patterns[4];
+    static unsigned char programs[4][256];
+    int i, j, n, matches = 0;
+    for (i = 0; i < 4; i++) {
+        osc_pattern_compile(&compiled_patterns[i], patterns[i], programs[i], sizeof(programs[i]));
+    }
     
+    int iterations = 1000000;
+    clock_t start = clock();
+    for (n = 0; n < iterations; n++) {
+        for (i = 0; i < 4; i++) {
+            for (j = 0; j < 4; j++) {
+                matches += osc_pattern_match(&compiled_patterns[i], inputs[j]);
+            }
+        }
+    }
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%.1f ns/match (%d matches)\n", elapsed * 1e9 / (iterations * 16.0), matches);
+    
+    /* one address against 1024 subscriptions: individually, then as a set */
+    static char subscriptions[1024][48];
+    static osc_pattern_t subscribed[1024];
+    static unsigned char subscribed_programs[1024][128];
+    static uint64_t big_buffer[1 << 17];
+    uint64_t big_matches[16];
+    osc_pattern_set_t big;
+    
+    osc_pattern_set_init(&big, 1024, 4096, big_buffer, sizeof(big_buffer));
+    for (i = 0; i < 1024; i++) {
+        switch (i & 3) {
+            case 0: sprintf(subscriptions[i], "/track/%d/param/*", i / 4); break;
+            case 1: sprintf(subscriptions[i], "/track/*/param/%d", i / 4); break;
+            case 2: sprintf(subscriptions[i], "/track/{%d,%d}/mute", i / 4, i / 4 + 1); break;
+            case 3: sprintf(subscriptions[i], "/bus/%d/level", i / 4); break;
+        }
+        osc_pattern_compile(&subscribed[i], subscriptions[i], subscribed_programs[i], sizeof(subscribed_programs[i]));
+        osc_pattern_set_add(&big, subscriptions[i]);
+    }
+    
+    const char *address = "/track/12/param/40";
+    iterations = 10000;
+    matches = 0;
+    start = clock();
+    for (n = 0; n < iterations; n++) {
+        for (i = 0; i < 1024; i++) matches += osc_pattern_match(&subscribed[i], address);
+    }
+    elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%.1f ns/address against 1024 patterns, one at a time (%d matches)\n", elapsed * 1e9 / iterations, matches / iterations);
+    
+    iterations = 1000000;
+    matches = 0;
+    start = clock();
+    for (n = 0; n < iterations; n++) {
+        matches += osc_pattern_set_match(&big, address, big_matches);
+    }
+    elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%.1f ns/address against 1024 patterns, as a set (%d matches)\n", elapsed * 1e9 / iterations, matches / iterations);
     
     return 0;
 }
\ No newline at end of file
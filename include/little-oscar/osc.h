@@ -13,12 +13,13 @@
  * as the constant OSC_GOT_PAL. You can also #define OSC_HAVE_VARARG to enable
  * vararg support (requires the usual va_list, va_start(), va_end() etc).
  *
- * Required types: int32_t, int64_t, uint32_t, uint64_t
- * Macros/functions: strlen(), osc_hton32(), osc_hton64(), osc_ntoh32(), osc_ntoh64()
+ * Required types: int32_t, int64_t, uint32_t, uint64_t, osc_iovec_t (a struct
+ * with `iov_base` and `iov_len` members, e.g. POSIX `struct iovec`)
+ * Macros/functions: strlen(), memcmp(), memcpy(), memmove(), memset(), osc_hton32(), osc_hton64(), osc_ntoh32(), osc_ntoh64()
  */
 #ifndef OSC_GOT_PAL
     #include <stdint.h>     /* int32_t, int64_t, uint32_t, uint64_t */
-    #include <string.h>     /* strlen() */
+    #include <string.h>     /* strlen(), memcmp(), memcpy(), memmove(), memset() */
     #include <stdarg.h>     /* va_list and friends */
     
     #define OSC_HAVE_VARARG 1
@@ -26,8 +27,17 @@
     #if defined(__WIN32) || defined(__WIN32__) || defined(__WIN64) || defined(__WIN64__)
         #define OSC_LITTLE_ENDIAN
         #include <winsock2.h>   /* htonl(), ntohl() */
+        #include <stddef.h>     /* size_t */
+        
+        typedef struct {
+            void    *iov_base;
+            size_t  iov_len;
+        } osc_iovec_t;
     #else
         #include <arpa/inet.h>  /* htonl(), ntohl() */
+        #include <sys/uio.h>    /* struct iovec */
+        
+        typedef struct iovec osc_iovec_t;
 
         #if defined BYTE_ORDER
             #if BYTE_ORDER == BIG_ENDIAN
@@ -120,10 +130,35 @@ typedef struct {
 typedef struct {
     const char              *msg_ptr;
     const char              *msg_end;
+    const char              *type_start;
     const char              *type_ptr;
     const char              *arg_ptr;
 } osc_msg_reader_t;
 
+#ifndef OSC_WALK_MAX_DEPTH
+#define OSC_WALK_MAX_DEPTH 8
+#endif
+
+/*
+ * callback for `osc_packet_walk()`; receives an initialised reader for each
+ * message and the timetag of its innermost enclosing bundle (OSC_NOW for a
+ * bare message). return OSC_OK to continue walking; any other value stops the
+ * walk and is returned to the caller.
+ */
+typedef int (*osc_packet_walk_cb)(osc_msg_reader_t *reader, osc_timetag_t timetag, void *userdata);
+
+#ifndef OSC_DECODER_MAX_ARGS
+#define OSC_DECODER_MAX_ARGS 16
+#endif
+
+typedef struct {
+    char                    typetag[OSC_DECODER_MAX_ARGS + 1];
+    unsigned char           ops[OSC_DECODER_MAX_ARGS];
+    int32_t                 offsets[OSC_DECODER_MAX_ARGS];
+    int                     nargs;
+    int                     fixed_size;
+} osc_msg_decoder_t;
+
 // Writing
 
 
@@ -134,10 +169,34 @@ int                 osc_bundle_reader_init(osc_bundle_reader_t *reader, const ch
 osc_timetag_t       osc_bundle_reader_get_timetag(osc_bundle_reader_t *reader);
 int                 osc_bundle_reader_next(osc_bundle_reader_t *reader, const char **start, int32_t *len);
 
+/*
+ * visit every message in a packet, descending into nested bundles up to
+ * OSC_WALK_MAX_DEPTH levels deep. messages are read in place; traversal uses
+ * a fixed-size stack rather than recursion.
+ * returns OSC_OK once every message has been visited, OSC_ERROR if the packet
+ * is malformed or nested too deeply, or the first non-OSC_OK value returned by
+ * `cb`. messages preceding a malformed element will already have been visited.
+ */
+int                 osc_packet_walk(const char *buffer, int len, osc_packet_walk_cb cb, void *userdata);
+
 int                 osc_msg_reader_init(osc_msg_reader_t *reader, const char *buffer, int len);
 int                 osc_msg_reader_is_typed(osc_msg_reader_t *reader);
 const char *        osc_msg_reader_get_address(osc_msg_reader_t *reader);
 
+/*
+ * returns the hash of the current message's address, computed on request so
+ * that readers which never dispatch don't pay for it. equal to
+ * `osc_address_hash()` of the address, so routes hashed when they are
+ * registered can be found with a single table probe.
+ */
+uint32_t            osc_msg_reader_get_address_hash(osc_msg_reader_t *reader);
+
+/*
+ * hash of a NUL-terminated address. hashes are computed in host byte order
+ * and are only comparable within a single process.
+ */
+uint32_t            osc_address_hash(const char *address);
+
 /*
  * convenience function.
  * read the current message's next argument (and its type) into the given
@@ -173,12 +232,189 @@ int                 osc_msg_reader_get_arg_double(osc_msg_reader_t *reader, doub
 int                 osc_msg_reader_get_arg_str(osc_msg_reader_t *reader, const char **val);
 int                 osc_msg_reader_get_arg_blob(osc_msg_reader_t *reader, void **val, int32_t *sz);
 
+/*
+ * check an entire packet in a single pass: bundle headers and element
+ * lengths, alignment, string termination, and agreement between each
+ * message's type tag and the size of its argument data. bundles may be
+ * nested up to OSC_WALK_MAX_DEPTH levels. messages with arguments but no type
+ * tag are rejected since their contents cannot be checked.
+ * returns OSC_OK if the packet is well-formed, OSC_ERROR otherwise.
+ */
+int                 osc_packet_validate(const char *buffer, int len);
+
+/*
+ * unchecked reader mode, for packets that have passed `osc_packet_validate()`
+ * or come from a trusted source. these behave like their checked counterparts
+ * but perform no bounds checking whatsoever; behaviour is undefined if the
+ * message is malformed.
+ */
+int                 osc_msg_reader_init_unchecked(osc_msg_reader_t *reader, const char *buffer, int len);
+int                 osc_msg_reader_get_arg_unchecked(osc_msg_reader_t *reader, osc_arg_t *arg);
+int                 osc_msg_reader_get_arg_int32_unchecked(osc_msg_reader_t *reader, int32_t *val);
+int                 osc_msg_reader_get_arg_int64_unchecked(osc_msg_reader_t *reader, int64_t *val);
+int                 osc_msg_reader_get_arg_timetag_unchecked(osc_msg_reader_t *reader, osc_timetag_t *val);
+int                 osc_msg_reader_get_arg_float_unchecked(osc_msg_reader_t *reader, float *val);
+int                 osc_msg_reader_get_arg_double_unchecked(osc_msg_reader_t *reader, double *val);
+int                 osc_msg_reader_get_arg_str_unchecked(osc_msg_reader_t *reader, const char **val);
+int                 osc_msg_reader_get_arg_blob_unchecked(osc_msg_reader_t *reader, void **val, int32_t *sz);
+
+/*
+ * bulk readers for runs of identical fixed-width arguments.
+ * starting at the current type pointer, consume up to `max` consecutive
+ * arguments of the matching type ('i', 'h', 'f' or 'd') and convert them into
+ * `vals`. the run is bounds-checked once, as a whole.
+ *
+ * returns the number of values read (0 if the next argument is of a different
+ * type or there are none left), or OSC_ERROR if the message has no type tag or
+ * the run would extend beyond the end of the message.
+ */
+int                 osc_msg_reader_get_int32_array(osc_msg_reader_t *reader, int32_t *vals, int max);
+int                 osc_msg_reader_get_int64_array(osc_msg_reader_t *reader, int64_t *vals, int max);
+int                 osc_msg_reader_get_float_array(osc_msg_reader_t *reader, float *vals, int max);
+int                 osc_msg_reader_get_double_array(osc_msg_reader_t *reader, double *vals, int max);
+
+/*
+ * walk the current message's type tag once, storing the offset of each
+ * argument's data in `offsets`. at most `max_args` arguments are indexed.
+ * the index remains valid for as long as the message buffer does, and allows
+ * arguments to be read in any order, any number of times, using
+ * `osc_msg_reader_seek_arg()`.
+ *
+ * returns the number of arguments indexed, or OSC_ERROR if the message has no
+ * type tag, contains an unsupported type, or an argument would extend beyond
+ * the end of the message.
+ */
+int                 osc_msg_reader_index_args(osc_msg_reader_t *reader, int32_t *offsets, int max_args);
+
+/*
+ * move the argument pointer to argument `ix` using an index built by
+ * `osc_msg_reader_index_args()`. behaves like `osc_msg_reader_next_arg()`:
+ * returns the argument's type, after which the matching
+ * `osc_msg_reader_get_arg_*()` function reads its value and subsequent calls
+ * to `osc_msg_reader_next_arg()` continue from argument `ix + 1`.
+ * no bounds checking is performed on `ix`.
+ */
+char                osc_msg_reader_seek_arg(osc_msg_reader_t *reader, const int32_t *offsets, int ix);
+
+/*
+ * compile a fixed message signature into a decoder.
+ * `typetag` is the expected type tag, with or without its leading ','.
+ * `offsets` gives, for each argument, the byte offset within the destination
+ * struct at which its value is stored (e.g. using `offsetof()`). 'i' and 'f'
+ * arguments are stored as int32_t/float, 'h', 't' and 'd' as
+ * int64_t/osc_timetag_t/double, and 's', 'S' and 'k' as `const char *`
+ * pointing into the message. 'T', 'F', 'N' and 'I' carry no data; their
+ * offsets are ignored.
+ * returns OSC_OK on success, or OSC_ERROR if the type tag has more than
+ * OSC_DECODER_MAX_ARGS arguments or contains an unsupported type.
+ */
+int                 osc_msg_decoder_init(osc_msg_decoder_t *decoder, const char *typetag, const int32_t *offsets);
+
+/*
+ * decode every argument of a freshly initialised message into `dest` using a
+ * compiled decoder. the message's type tag is checked with a single
+ * comparison; if it matches, each argument is written straight to its
+ * destination offset and the reader is left positioned after the last
+ * argument.
+ * returns OSC_OK on success, or OSC_ERROR if the type tag does not match or
+ * the arguments extend beyond the end of the message.
+ */
+int                 osc_msg_reader_decode(osc_msg_reader_t *reader, const osc_msg_decoder_t *decoder, void *dest);
+
+//
+// Stream framing
+
+/*
+ * incremental decoder for OSC carried over stream transports (TCP, serial).
+ * bytes are accumulated in a caller-provided ring buffer and complete packets
+ * are handed out one at a time, pointing directly into the ring whenever the
+ * packet is contiguous. packets that wrap around the end of the ring are
+ * reassembled in a caller-provided scratch buffer.
+ *
+ * OSC_STREAM_SIZE_PREFIX - OSC 1.0 framing; each packet is preceded by its
+ *                          length as a big-endian int32
+ * OSC_STREAM_SLIP        - OSC 1.1 framing; packets are SLIP-encoded
+ *                          (RFC 1055) and delimited by END bytes
+ */
+enum {
+    OSC_STREAM_SIZE_PREFIX      = 1,
+    OSC_STREAM_SLIP             = 2
+};
+
 typedef struct {
+    char                    *buffer;
+    int                     cap;
+    int                     head;
+    int                     len;
+    int                     scanned;
+    int                     release;
+    char                    *scratch;
+    int                     scratch_len;
+    int                     framing;
+    int                     skipping;       /* SLIP: discarding an oversized frame up to its END */
+} osc_stream_t;
+
+int                 osc_stream_init(osc_stream_t *stream, int framing, void *buffer, int len, void *scratch, int scratch_len);
+
+/*
+ * find the largest contiguous free region of the ring, so that data can be
+ * read directly into it (e.g. `read(fd, ptr, avail)`), then report how many
+ * bytes were written with `osc_stream_commit()`.
+ * returns the size of the region, which is 0 if the ring is full.
+ */
+int                 osc_stream_write_ptr(osc_stream_t *stream, char **ptr);
+void                osc_stream_commit(osc_stream_t *stream, int len);
+
+/*
+ * copy a chunk of received data into the ring.
+ * returns the number of bytes accepted, which may be less than `len` if the
+ * ring is full; drain packets with `osc_stream_next()` and feed the rest.
+ */
+int                 osc_stream_feed(osc_stream_t *stream, const char *data, int len);
+
+/*
+ * extract the next complete packet. on success `*packet` and `*len` describe
+ * the packet, which remains valid until the next call to this function.
+ * returns OSC_OK if a packet was extracted, OSC_END if more data is needed,
+ * or OSC_ERROR if the stream is corrupt or a packet cannot fit in the ring (or,
+ * when it wraps, the scratch buffer). SLIP streams skip the offending frame
+ * and may continue to be read; size-prefixed streams lose their framing and
+ * should be closed.
+ */
+int                 osc_stream_next(osc_stream_t *stream, const char **packet, int *len);
+
+struct osc_writer;
+
+/*
+ * growth callback for writers. called when a write needs the buffer to hold
+ * at least `min_len` bytes; must either update `writer->data` and
+ * `writer->len` (preserving the first `writer->pos` bytes) and return OSC_OK,
+ * or return OSC_ERROR.
+ */
+typedef int (*osc_writer_grow_fn)(struct osc_writer *writer, int min_len, void *userdata);
+
+#ifndef OSC_WRITER_MAX_DEPTH
+#define OSC_WRITER_MAX_DEPTH 8
+#endif
+
+typedef struct osc_writer {
     char                    *data;
     int                     len;
     int                     pos;
     int                     msg_start;
     int                     type_pos;
+    osc_iovec_t             *iov;
+    int                     iov_max;
+    int                     iov_count;
+    int                     iov_mark;
+    int                     ext_len;
+    int                     msg_ext_start;
+    osc_writer_grow_fn      grow;
+    void                    *grow_userdata;
+    int                     sizing;
+    int                     depth;
+    int                     bundle_start[OSC_WRITER_MAX_DEPTH];
+    int                     bundle_ext_start[OSC_WRITER_MAX_DEPTH];
     enum {
         OSC_WRITER_OUT          = 1,
         OSC_WRITER_BUNDLE       = 2,
@@ -187,11 +423,53 @@ typedef struct {
     }                       state;
 } osc_writer_t;
 
+/*
+ * a writer initialised with a NULL buffer is a sizing writer: it accepts the
+ * same calls as any other writer but stores nothing, so that afterwards
+ * `writer->pos` holds the exact encoded size. osc_msg_writer_reserve_msg() is
+ * not supported by sizing writers.
+ */
 int osc_msg_writer_init(osc_writer_t *writer, void *buffer_or_writer, int len);
 int osc_msg_writer_start_msg(osc_writer_t *writer, const char *address, int nargs);
 int osc_msg_writer_end_msg(osc_writer_t *writer);
+
+/*
+ * bundles may be nested up to OSC_WRITER_MAX_DEPTH levels: starting a bundle
+ * inside an open bundle adds it as an element, and its size is filled in by
+ * the matching osc_msg_writer_end_bundle(). ending the outermost bundle
+ * completes the packet.
+ */
 int osc_msg_writer_start_bundle(osc_writer_t *writer, osc_timetag_t timetag);
 int osc_msg_writer_end_bundle(osc_writer_t *writer);
+
+/*
+ * reserve `len` bytes (a multiple of 4) for a message the caller encodes
+ * directly, and return a pointer to them, or NULL on error. inside a bundle the
+ * element's size prefix is handled as usual. the message must be completed
+ * with osc_msg_writer_end_msg().
+ */
+char* osc_msg_writer_reserve_msg(osc_writer_t *writer, int len);
+
+//
+// Sizing
+
+/* encoded size of a string argument (or address) */
+int osc_str_size(const char *str);
+
+/* encoded size of a blob argument with `sz` bytes of data */
+int osc_blob_size(int32_t sz);
+
+/*
+ * encoded size of a message with the given address and typetag (with or
+ * without its leading ','). fixed-width arguments are sized from the typetag;
+ * `var_len` must be the total osc_str_size()/osc_blob_size() of its string and
+ * blob arguments. returns OSC_ERROR if the typetag contains an unknown type.
+ */
+int osc_msg_size(const char *address, const char *typetag, int var_len);
+
+/* encoded size of a bundle of `count` elements totalling `elems_len` bytes */
+int osc_bundle_size(int count, int elems_len);
+
 int osc_msg_write_null(osc_writer_t *writer);
 int osc_msg_write_true(osc_writer_t *writer);
 int osc_msg_write_false(osc_writer_t *writer);
@@ -204,6 +482,194 @@ int osc_msg_write_double(osc_writer_t *writer, double val);
 int osc_msg_write_str(osc_writer_t *writer, const char *val);
 int osc_msg_write_blob(osc_writer_t *writer, unsigned char *val, int32_t sz);
 
+/*
+ * bulk writers for runs of identical fixed-width arguments.
+ * append `count` arguments of the matching type ('i', 'h', 'f' or 'd'),
+ * converting the whole run into the buffer at once. each value counts as one
+ * argument towards the `nargs` passed to osc_msg_writer_start_msg().
+ */
+int osc_msg_write_int32_array(osc_writer_t *writer, const int32_t *vals, int count);
+int osc_msg_write_int64_array(osc_writer_t *writer, const int64_t *vals, int count);
+int osc_msg_write_float_array(osc_writer_t *writer, const float *vals, int count);
+int osc_msg_write_double_array(osc_writer_t *writer, const double *vals, int count);
+
+/*
+ * growable writers.
+ *
+ * `osc_msg_writer_init_growable()` attaches a growth callback which is invoked
+ * whenever a write would overflow the buffer, instead of failing. `buffer` may
+ * be NULL if `len` is 0; unlike osc_msg_writer_init(), this does not make it a
+ * sizing writer.
+ */
+int osc_msg_writer_init_growable(osc_writer_t *writer, void *buffer, int len, osc_writer_grow_fn grow, void *userdata);
+
+#ifndef OSC_GOT_PAL
+/*
+ * growth callback backed by realloc(); at least doubles the buffer each time.
+ * the writer's buffer must be NULL or have come from malloc(), and is owned
+ * (and must eventually be freed) by the caller.
+ */
+int osc_writer_grow_realloc(osc_writer_t *writer, int min_len, void *userdata);
+#endif
+
+/*
+ * bump-pointer arena.
+ *
+ * carves allocations out of a single caller-provided block. nothing is ever
+ * freed individually; `osc_arena_reset()` releases everything at once, so a
+ * burst of messages (e.g. one frame's worth) can be built with no per-message
+ * allocation and discarded in constant time.
+ */
+typedef struct {
+    char                    *data;
+    int                     len;
+    int                     used;
+} osc_arena_t;
+
+void  osc_arena_init(osc_arena_t *arena, void *buffer, int len);
+void  osc_arena_reset(osc_arena_t *arena);
+
+/* returns an 8-byte aligned block of `len` bytes, or NULL if the arena is full */
+void *osc_arena_alloc(osc_arena_t *arena, int len);
+
+/*
+ * start a writer at the top of the arena. the writer may use all remaining
+ * space; once the packet is complete, `osc_arena_commit()` claims the bytes
+ * actually written and returns a pointer to them, valid until the arena is
+ * reset. at most one writer may be open on an arena at a time and no other
+ * allocations may be made while it is.
+ */
+int   osc_msg_writer_init_arena(osc_writer_t *writer, osc_arena_t *arena);
+char *osc_arena_commit(osc_arena_t *arena, osc_writer_t *writer);
+
+/*
+ * scatter-gather writing.
+ *
+ * a writer initialised with `osc_msg_writer_init_iov()` can reference large
+ * blob and string payloads instead of copying them. headers, type tags and
+ * all other arguments are still written to the writer's buffer; the output is
+ * described by an array of up to `iov_max` iovecs, suitable for `writev()` or
+ * `sendmsg()`, interleaving buffer segments with referenced payloads and any
+ * padding they need (taken from a shared static block of zeroes).
+ *
+ * referenced data must remain valid until the iovecs have been sent. on a
+ * writer without an iovec array the `_ref` functions copy, like their
+ * non-ref counterparts.
+ */
+int osc_msg_writer_init_iov(osc_writer_t *writer, void *buffer, int len, osc_iovec_t *iov, int iov_max);
+int osc_msg_write_blob_ref(osc_writer_t *writer, const void *val, int32_t sz);
+int osc_msg_write_str_ref(osc_writer_t *writer, const char *val);
+
+/*
+ * emit the final buffer segment and resolve buffer segment addresses.
+ * returns the number of iovecs used, or OSC_ERROR if the array is full.
+ */
+int osc_msg_writer_finish_iov(osc_writer_t *writer);
+
+//
+// Message templates
+
+#ifndef OSC_TEMPLATE_MAX_ARGS
+#define OSC_TEMPLATE_MAX_ARGS 16
+#endif
+
+typedef struct {
+    char                    *data;
+    int                     len;
+    int                     nargs;
+    int32_t                 offsets[OSC_TEMPLATE_MAX_ARGS];
+} osc_msg_template_t;
+
+/*
+ * pre-encode a message with a fixed address and type tag into `buffer`,
+ * recording the offset of each argument. only fixed-width types ('i', 'h',
+ * 't', 'f', 'd', 'T', 'F', 'N', 'I') are supported; arguments are initially
+ * zero. the buffer holds the template's image and must outlive it.
+ * returns OSC_OK on success, or OSC_ERROR if the buffer is too small or the
+ * type tag is unsupported or has more than OSC_TEMPLATE_MAX_ARGS arguments.
+ */
+int  osc_msg_template_init(osc_msg_template_t *tpl, void *buffer, int len, const char *address, const char *typetag);
+
+/*
+ * store argument `ix` directly into the template's image, in network byte
+ * order. no type or bounds checking is performed.
+ */
+void osc_msg_template_set_int32(osc_msg_template_t *tpl, int ix, int32_t val);
+void osc_msg_template_set_int64(osc_msg_template_t *tpl, int ix, int64_t val);
+void osc_msg_template_set_timetag(osc_msg_template_t *tpl, int ix, osc_timetag_t val);
+void osc_msg_template_set_float(osc_msg_template_t *tpl, int ix, float val);
+void osc_msg_template_set_double(osc_msg_template_t *tpl, int ix, double val);
+
+/*
+ * copy the template's current image into `buffer`.
+ * returns the number of bytes copied, or OSC_ERROR if `len` is too small.
+ */
+int  osc_msg_template_copy(const osc_msg_template_t *tpl, void *buffer, int len);
+
+/*
+ * append the template's current image to a writer as a complete message,
+ * equivalent to encoding the same values with osc_msg_writer_start_msg(),
+ * the osc_msg_write_ functions and osc_msg_writer_end_msg().
+ */
+int  osc_msg_writer_write_template(osc_writer_t *writer, const osc_msg_template_t *tpl);
+
+//
+// Bundle packer
+
+/*
+ * packs many small messages into bundles of at most `mtu` bytes, so they can
+ * be sent as a few large datagrams rather than many small ones.
+ *
+ * a bundle is passed to the flush callback when the next message would take
+ * it past the MTU, when a message with a different timetag is started, or
+ * when `max_latency` has passed since its first message was added (checked
+ * whenever the packer is used, and by `osc_packer_poll()`). a bundle holding
+ * a single message with timetag OSC_NOW is sent as a bare message.
+ *
+ * times (`now`, `max_latency`) are in caller-defined units, typically
+ * microseconds from a monotonic clock.
+ */
+typedef void (*osc_packer_flush_cb)(const char *packet, int len, void *userdata);
+
+typedef struct {
+    osc_writer_t            writer;
+    char                    *buffer;
+    int                     len;
+    int                     mtu;
+    int                     count;
+    int                     elem_start;
+    osc_timetag_t           timetag;
+    uint64_t                max_latency;
+    uint64_t                deadline;
+    osc_packer_flush_cb     flush;
+    void                    *userdata;
+} osc_packer_t;
+
+/*
+ * `buffer` must be at least `mtu` bytes; any excess is used to encode a
+ * message that doesn't fit in the current bundle before moving it into the
+ * next one. a message that exceeds the MTU on its own is sent regardless.
+ */
+int           osc_packer_init(osc_packer_t *packer, void *buffer, int len, int mtu, uint64_t max_latency, osc_packer_flush_cb flush, void *userdata);
+
+/*
+ * start a message in the current bundle and return the writer to write its
+ * arguments with, or NULL on error. complete the message with
+ * `osc_packer_end_msg()`, or discard it with `osc_packer_cancel_msg()`.
+ */
+osc_writer_t* osc_packer_start_msg(osc_packer_t *packer, osc_timetag_t timetag, const char *address, int nargs, uint64_t now);
+int           osc_packer_end_msg(osc_packer_t *packer, uint64_t now);
+void          osc_packer_cancel_msg(osc_packer_t *packer);
+
+/* add a complete, already-encoded message */
+int           osc_packer_add(osc_packer_t *packer, osc_timetag_t timetag, const char *msg, int len, uint64_t now);
+
+/* flush the current bundle if its deadline has passed */
+int           osc_packer_poll(osc_packer_t *packer, uint64_t now);
+
+/* flush the current bundle, if any */
+int           osc_packer_flush(osc_packer_t *packer);
+
 #ifdef OSC_HAVE_VARARG
 int osc_writev(osc_writer_t *writer, const char *address, const char *typestring, va_list args);
 int osc_write(osc_writer_t *writer, const char *address, const char *typestring, ...);
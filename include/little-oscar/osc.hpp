@@ -0,0 +1,319 @@
+#ifndef OSC_HPP
+#define OSC_HPP
+
+/*
+ * C++17 front-end for little-oscar.
+ *
+ * messages are described by their argument types; the typetag is built at
+ * compile time and, when every argument is fixed-width, so is the encoded
+ * size. encoding is a single reserve followed by straight-line stores, and
+ * decoding is a single typetag comparison followed by (for fixed-width
+ * signatures) a single bounds check.
+ *
+ *   osc::write(writer, "/meter", 3, 0.5f);
+ *   auto vals = osc::decode<int32_t, float>(msg, len);  // std::optional<std::tuple<...>>
+ *
+ * argument types:
+ *   int32_t 'i', int64_t 'h', float 'f', double 'd', osc::timetag 't',
+ *   const char* / std::string_view 's', osc::blob 'b', osc::nil 'N',
+ *   osc::infinitum 'I'. strings and blobs decode to views into the message.
+ */
+
+#include "osc.h"
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace osc {
+
+struct timetag      { osc_timetag_t value; };
+struct blob         { const void *data; int32_t size; };
+struct nil          {};
+struct infinitum    {};
+
+namespace detail {
+
+constexpr int round32(int len) { return (len + 3) & ~3; }
+
+inline void store32(char *dst, uint32_t val) {
+    val = osc_hton32(val);
+    memcpy(dst, &val, 4);
+}
+
+inline void store64(char *dst, uint64_t val) {
+    val = osc_hton64(val);
+    memcpy(dst, &val, 8);
+}
+
+inline uint32_t load32(const char *src) {
+    uint32_t val;
+    memcpy(&val, src, 4);
+    return osc_ntoh32(val);
+}
+
+inline uint64_t load64(const char *src) {
+    uint64_t val;
+    memcpy(&val, src, 8);
+    return osc_ntoh64(val);
+}
+
+template <typename T> struct arg_traits;
+
+/*
+ * each specialisation provides:
+ *   tag         - typetag character
+ *   width       - encoded size, or 0 if it depends on the value
+ *   size(v)     - encoded size of `v`
+ *   put(dst, v) - encode `v` at `dst`, returning the number of bytes written
+ *   get(r, v)   - decode into `v` with bounds checking (variable-width types)
+ *   get(src)    - decode from `src` without checks (fixed-width types)
+ */
+
+template <> struct arg_traits<int32_t> {
+    static constexpr char tag = 'i';
+    static constexpr int width = 4;
+    static constexpr int size(int32_t) { return 4; }
+    static int put(char *dst, int32_t v) { store32(dst, (uint32_t)v); return 4; }
+    static int32_t get(const char *src) { return (int32_t)load32(src); }
+};
+
+template <> struct arg_traits<int64_t> {
+    static constexpr char tag = 'h';
+    static constexpr int width = 8;
+    static constexpr int size(int64_t) { return 8; }
+    static int put(char *dst, int64_t v) { store64(dst, (uint64_t)v); return 8; }
+    static int64_t get(const char *src) { return (int64_t)load64(src); }
+};
+
+template <> struct arg_traits<timetag> {
+    static constexpr char tag = 't';
+    static constexpr int width = 8;
+    static constexpr int size(timetag) { return 8; }
+    static int put(char *dst, timetag v) { store64(dst, v.value); return 8; }
+    static timetag get(const char *src) { return timetag{ load64(src) }; }
+};
+
+template <> struct arg_traits<float> {
+    static constexpr char tag = 'f';
+    static constexpr int width = 4;
+    static constexpr int size(float) { return 4; }
+    static int put(char *dst, float v) { uint32_t u; memcpy(&u, &v, 4); store32(dst, u); return 4; }
+    static float get(const char *src) { uint32_t u = load32(src); float v; memcpy(&v, &u, 4); return v; }
+};
+
+template <> struct arg_traits<double> {
+    static constexpr char tag = 'd';
+    static constexpr int width = 8;
+    static constexpr int size(double) { return 8; }
+    static int put(char *dst, double v) { uint64_t u; memcpy(&u, &v, 8); store64(dst, u); return 8; }
+    static double get(const char *src) { uint64_t u = load64(src); double v; memcpy(&v, &u, 8); return v; }
+};
+
+template <> struct arg_traits<nil> {
+    static constexpr char tag = 'N';
+    static constexpr int width = 0;
+    static constexpr int size(nil) { return 0; }
+    static int put(char*, nil) { return 0; }
+    static nil get(const char*) { return nil{}; }
+};
+
+template <> struct arg_traits<infinitum> {
+    static constexpr char tag = 'I';
+    static constexpr int width = 0;
+    static constexpr int size(infinitum) { return 0; }
+    static int put(char*, infinitum) { return 0; }
+    static infinitum get(const char*) { return infinitum{}; }
+};
+
+template <> struct arg_traits<std::string_view> {
+    static constexpr char tag = 's';
+    static constexpr int width = 0;
+    static int size(std::string_view v) { return round32((int)v.size() + 1); }
+    static int put(char *dst, std::string_view v) {
+        int len = size(v);
+        memcpy(dst, v.data(), v.size());
+        memset(dst + v.size(), 0, len - v.size());
+        return len;
+    }
+    static bool get(osc_msg_reader_t *reader, std::string_view *v) {
+        const char *str;
+        if (osc_msg_reader_get_arg_str(reader, &str) != OSC_OK) return false;
+        *v = std::string_view(str);
+        return true;
+    }
+};
+
+template <> struct arg_traits<const char*> {
+    static constexpr char tag = 's';
+    static constexpr int width = 0;
+    static int size(const char *v) { return round32((int)strlen(v) + 1); }
+    static int put(char *dst, const char *v) { return arg_traits<std::string_view>::put(dst, std::string_view(v)); }
+    static bool get(osc_msg_reader_t *reader, const char **v) {
+        return osc_msg_reader_get_arg_str(reader, v) == OSC_OK;
+    }
+};
+
+template <> struct arg_traits<blob> {
+    static constexpr char tag = 'b';
+    static constexpr int width = 0;
+    static int size(blob v) { return 4 + round32(v.size); }
+    static int put(char *dst, blob v) {
+        int len = size(v);
+        store32(dst, (uint32_t)v.size);
+        memcpy(dst + 4, v.data, v.size);
+        memset(dst + 4 + v.size, 0, len - 4 - v.size);
+        return len;
+    }
+    static bool get(osc_msg_reader_t *reader, blob *v) {
+        void *data;
+        if (osc_msg_reader_get_arg_blob(reader, &data, &v->size) != OSC_OK) return false;
+        v->data = data;
+        return true;
+    }
+};
+
+/* string literals and other char arrays encode as strings */
+template <std::size_t N> struct arg_traits<char[N]> : arg_traits<const char*> {};
+template <> struct arg_traits<char*> : arg_traits<const char*> {};
+
+template <typename T>
+using traits_of = arg_traits<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template <typename... Ts>
+constexpr bool all_fixed = ((traits_of<Ts>::width > 0 || traits_of<Ts>::tag == 'N' || traits_of<Ts>::tag == 'I') && ...);
+
+} // namespace detail
+
+/*
+ * the padded typetag for a signature, including the leading ',', e.g.
+ * typetag<int32_t, float>() == ",if\0"
+ */
+template <typename... Ts>
+constexpr std::array<char, detail::round32(sizeof...(Ts) + 2)> typetag() {
+    std::array<char, detail::round32(sizeof...(Ts) + 2)> tag{};
+    tag[0] = ',';
+    std::size_t ix = 1;
+    ((tag[ix++] = detail::traits_of<Ts>::tag), ...);
+    return tag;
+}
+
+/* encoded size of the arguments of a fixed-width signature */
+template <typename... Ts>
+constexpr int args_size() {
+    static_assert(detail::all_fixed<Ts...>, "signature contains variable-width arguments");
+    return (0 + ... + detail::traits_of<Ts>::width);
+}
+
+/* exact encoded size of a message, excluding any bundle size prefix */
+template <typename... Ts>
+inline int msg_size(std::string_view address, const Ts&... args) {
+    int size = detail::round32((int)address.size() + 1) + (int)sizeof(typetag<Ts...>());
+    if constexpr (detail::all_fixed<Ts...>) {
+        return size + args_size<Ts...>();
+    } else {
+        return size + (0 + ... + detail::traits_of<Ts>::size(args));
+    }
+}
+
+/*
+ * append a complete message to `writer` (at the top level, or as an element of
+ * the open bundle). returns OSC_OK or OSC_ERROR.
+ */
+template <typename... Ts>
+inline int write(osc_writer_t &writer, std::string_view address, const Ts&... args) {
+    static constexpr auto tag = typetag<Ts...>();
+
+    char *dst = osc_msg_writer_reserve_msg(&writer, msg_size(address, args...));
+    if (!dst) return OSC_ERROR;
+
+    dst += detail::arg_traits<std::string_view>::put(dst, address);
+    memcpy(dst, tag.data(), tag.size());
+    dst += tag.size();
+    ((dst += detail::traits_of<Ts>::put(dst, args)), ...);
+
+    return osc_msg_writer_end_msg(&writer);
+}
+
+namespace detail {
+
+/* true if the reader's typetag is exactly that of the signature */
+template <typename... Ts>
+inline bool match(const osc_msg_reader_t &reader) {
+    static constexpr auto tag = typetag<Ts...>();
+    if (!reader.type_start) return false;
+    /* the padded typetag lies between the ',' and the first argument */
+    const char *start = reader.type_start - 1;
+    if (reader.arg_ptr - start != (std::ptrdiff_t)tag.size()) return false;
+    return memcmp(start, tag.data(), sizeof...(Ts) + 2) == 0;
+}
+
+template <typename... Ts, std::size_t... Is>
+inline bool read_fixed(osc_msg_reader_t &reader, std::tuple<Ts...> &out, std::index_sequence<Is...>) {
+    if (reader.msg_end - reader.arg_ptr < args_size<Ts...>()) return false;
+    const char *src = reader.arg_ptr;
+    ((std::get<Is>(out) = traits_of<Ts>::get(src), src += traits_of<Ts>::width), ...);
+    reader.arg_ptr = src;
+    return true;
+}
+
+template <typename T>
+inline bool read_one(osc_msg_reader_t &reader, T *val) {
+    if constexpr (traits_of<T>::width > 0) {
+        if (reader.msg_end - reader.arg_ptr < traits_of<T>::width) return false;
+        *val = traits_of<T>::get(reader.arg_ptr);
+        reader.arg_ptr += traits_of<T>::width;
+        return true;
+    } else if constexpr (traits_of<T>::tag == 'N' || traits_of<T>::tag == 'I') {
+        return true;
+    } else {
+        return traits_of<T>::get(&reader, val);
+    }
+}
+
+template <typename... Ts, std::size_t... Is>
+inline bool read_each(osc_msg_reader_t &reader, std::tuple<Ts...> &out, std::index_sequence<Is...>) {
+    return (read_one(reader, &std::get<Is>(out)) && ...);
+}
+
+} // namespace detail
+
+/*
+ * decode the arguments of `msg` into `out`. fails (returning false) unless the
+ * message's typetag is exactly that of the signature and every argument lies
+ * within the message.
+ */
+template <typename... Ts>
+inline bool decode(const char *msg, int len, std::tuple<Ts...> &out) {
+    osc_msg_reader_t reader;
+    if (osc_msg_reader_init(&reader, msg, len) != OSC_OK) return false;
+    if (!detail::match<Ts...>(reader)) return false;
+    if constexpr (detail::all_fixed<Ts...>) {
+        return detail::read_fixed(reader, out, std::index_sequence_for<Ts...>{});
+    } else {
+        return detail::read_each(reader, out, std::index_sequence_for<Ts...>{});
+    }
+}
+
+template <typename... Ts>
+inline std::optional<std::tuple<Ts...>> decode(const char *msg, int len) {
+    std::tuple<Ts...> out;
+    if (!decode(msg, len, out)) return std::nullopt;
+    return out;
+}
+
+/* decode into an aggregate whose members are initialised from `Ts...`, in order */
+template <typename S, typename... Ts>
+inline std::optional<S> decode_as(const char *msg, int len) {
+    std::tuple<Ts...> out;
+    if (!decode(msg, len, out)) return std::nullopt;
+    return std::apply([](auto&&... vals) { return S{ vals... }; }, out);
+}
+
+} // namespace osc
+
+#endif
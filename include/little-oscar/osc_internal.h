@@ -9,4 +9,36 @@
 
 #include "little-oscar/osc.h"
 
+/*
+ * returns the offset of the first NUL in [ptr, end), or OSC_ERROR if there is
+ * none. never reads at or beyond `end`.
+ */
+int osc_scan_nul(const char *ptr, const char *end);
+
+/*
+ * as `osc_scan_nul()`, additionally storing the hash of the bytes preceding
+ * the NUL in `*hash` (see `osc_address_hash()`).
+ */
+int osc_scan_nul_hash(const char *ptr, const char *end, uint32_t *hash);
+
+/*
+ * copy `count` 32/64-bit values from `src` to `dst`, converting between host
+ * and network byte order. neither pointer needs to be aligned.
+ */
+void osc_swap32(void *dst, const void *src, int count);
+void osc_swap64(void *dst, const void *src, int count);
+
+/*
+ * ensure the writer has room for `rlen` more bytes, growing it if possible.
+ * returns OSC_OK or OSC_ERROR.
+ */
+int osc_writer_reserve(osc_writer_t *writer, int rlen);
+
+/*
+ * open a message of `len` bytes whose content the caller supplies at
+ * `writer->data + writer->msg_start` (unless the writer is only sizing),
+ * including its size prefix when inside a bundle. returns OSC_OK or OSC_ERROR.
+ */
+int osc_writer_open_msg(osc_writer_t *writer, int len);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef OSC_UDP_H
+#define OSC_UDP_H
+
+/*
+ * Batched UDP receive engine.
+ *
+ * Unlike the rest of little-oscar this module depends on BSD sockets and
+ * malloc(), so it lives in its own header and is not required on
+ * microcontroller targets.
+ *
+ * On Linux datagrams are pulled with recvmmsg(), up to `batch` per syscall;
+ * elsewhere the engine falls back to one blocking recvfrom() followed by
+ * non-blocking reads until the batch is full or the socket is drained.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "little-oscar/osc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * called once per received datagram. `buffer` points into the receiver's slab
+ * and is only valid until the callback returns.
+ */
+typedef void (*osc_udp_packet_cb)(const char *buffer, int len,
+                                  const struct sockaddr *from, socklen_t from_len,
+                                  void *userdata);
+
+typedef struct {
+    int                     fd;
+    int                     batch;
+    int                     packet_size;
+    int                     slot_size;
+    char                    *slab;
+    void                    *msgs;      /* struct mmsghdr[batch] */
+    void                    *iovs;      /* struct iovec[batch] */
+    struct sockaddr_storage *addrs;
+} osc_udp_receiver_t;
+
+/*
+ * initialise a receiver for the bound datagram socket `fd`, preallocating
+ * `batch` packet buffers of `packet_size` bytes each.
+ * returns OSC_OK on success, OSC_ERROR if allocation fails.
+ */
+int     osc_udp_receiver_init(osc_udp_receiver_t *rx, int fd, int batch, int packet_size);
+void    osc_udp_receiver_teardown(osc_udp_receiver_t *rx);
+
+/*
+ * block until at least one datagram is available, then receive up to `batch`
+ * datagrams and pass each to `cb`. datagrams truncated to `packet_size` are
+ * dropped without invoking the callback.
+ * returns the number of datagrams received, or OSC_ERROR (errno is set).
+ */
+int     osc_udp_receiver_poll(osc_udp_receiver_t *rx, osc_udp_packet_cb cb, void *userdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
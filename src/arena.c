@@ -0,0 +1,48 @@
+#include "little-oscar/osc_internal.h"
+
+#ifndef OSC_GOT_PAL
+#include <stdlib.h>
+#endif
+
+#define ALIGN8(i) (((i) + 7) & ~7)
+
+void osc_arena_init(osc_arena_t *arena, void *buffer, int len) {
+    arena->data = (char*)buffer;
+    arena->len  = len;
+    arena->used = 0;
+}
+
+void osc_arena_reset(osc_arena_t *arena) {
+    arena->used = 0;
+}
+
+void *osc_arena_alloc(osc_arena_t *arena, int len) {
+    int start = ALIGN8(arena->used);
+    if (len < 0 || arena->len - start < len) return NULL;
+    arena->used = start + len;
+    return arena->data + start;
+}
+
+int osc_msg_writer_init_arena(osc_writer_t *writer, osc_arena_t *arena) {
+    int start = ALIGN8(arena->used);
+    if (start > arena->len) start = arena->len;
+    return osc_msg_writer_init_growable(writer, arena->data + start, arena->len - start, NULL, NULL);
+}
+
+char *osc_arena_commit(osc_arena_t *arena, osc_writer_t *writer) {
+    return (char*)osc_arena_alloc(arena, writer->pos);
+}
+
+#ifndef OSC_GOT_PAL
+
+int osc_writer_grow_realloc(osc_writer_t *writer, int min_len, void *userdata) {
+    int new_len = writer->len ? writer->len : 64;
+    while (new_len < min_len) new_len *= 2;
+    char *data = (char*)realloc(writer->data, new_len);
+    if (!data) return OSC_ERROR;
+    writer->data = data;
+    writer->len = new_len;
+    return OSC_OK;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "little-oscar/osc_internal.h"
+
+enum {
+    OP_NONE         = 0,
+    OP_32           = 1,
+    OP_64           = 2,
+    OP_STR          = 3
+};
+
+int osc_msg_decoder_init(osc_msg_decoder_t *decoder, const char *typetag, const int32_t *offsets) {
+    
+    if (*typetag == ',') typetag++;
+    
+    int fixed = 1, size = 0, ix = 0;
+    for (; typetag[ix]; ix++) {
+        if (ix == OSC_DECODER_MAX_ARGS) return OSC_ERROR;
+        unsigned char op;
+        switch (typetag[ix]) {
+            case 'T':   /* fall through */
+            case 'F':   /* fall through */
+            case 'N':   /* fall through */
+            case 'I':   op = OP_NONE; break;
+            case 'i':   /* fall through */
+            case 'f':   op = OP_32; size += 4; break;
+            case 'h':   /* fall through */
+            case 't':   /* fall through */
+            case 'd':   op = OP_64; size += 8; break;
+            case 'k':   /* fall through */
+            case 's':   /* fall through */
+            case 'S':   op = OP_STR; fixed = 0; break;
+            default:    return OSC_ERROR;
+        }
+        decoder->typetag[ix] = typetag[ix];
+        decoder->ops[ix] = op;
+        decoder->offsets[ix] = offsets[ix];
+    }
+    
+    decoder->typetag[ix] = '\0';
+    decoder->nargs = ix;
+    decoder->fixed_size = fixed ? size : -1;
+    
+    return OSC_OK;
+    
+}
+
+int osc_msg_reader_decode(osc_msg_reader_t *reader, const osc_msg_decoder_t *decoder, void *dest) {
+    
+    int nargs = decoder->nargs;
+    
+    /* compare including the terminator so longer type tags are rejected too */
+    if (!reader->type_ptr
+        || reader->msg_end - reader->type_ptr < nargs + 1
+        || memcmp(reader->type_ptr, decoder->typetag, nargs + 1) != 0) {
+        return OSC_ERROR;
+    }
+    
+    const char *arg_ptr = reader->arg_ptr;
+    const char *msg_end = reader->msg_end;
+    char *out = (char*)dest;
+    
+    /* all-fixed signatures need only a single bounds check */
+    int checked = decoder->fixed_size < 0;
+    if (!checked && msg_end - arg_ptr < decoder->fixed_size) return OSC_ERROR;
+    
+    int ix;
+    for (ix = 0; ix < nargs; ix++) {
+        char *target = out + decoder->offsets[ix];
+        switch (decoder->ops[ix]) {
+            case OP_NONE:
+                break;
+            case OP_32:
+                if (checked && msg_end - arg_ptr < 4) return OSC_ERROR;
+                *((uint32_t*)target) = osc_ntoh32(*((uint32_t*)arg_ptr));
+                arg_ptr += 4;
+                break;
+            case OP_64:
+            {
+                if (checked && msg_end - arg_ptr < 8) return OSC_ERROR;
+                uint64_t raw = *((uint64_t*)arg_ptr);
+                *((uint64_t*)target) = osc_ntoh64(raw);
+                arg_ptr += 8;
+                break;
+            }
+            case OP_STR:
+            {
+                int len = osc_scan_nul(arg_ptr, msg_end);
+                if (len < 0 || msg_end - arg_ptr < ROUND32(len + 1)) return OSC_ERROR;
+                *((const char**)target) = arg_ptr;
+                arg_ptr += ROUND32(len + 1);
+                break;
+            }
+        }
+    }
+    
+    reader->type_ptr += nargs;
+    reader->arg_ptr = arg_ptr;
+    
+    return OSC_OK;
+    
+}
@@ -0,0 +1,125 @@
+#include "little-oscar/osc_internal.h"
+
+#define BUNDLE_HEADER_LEN 16
+
+static void reset(osc_packer_t *packer) {
+    osc_msg_writer_init(&packer->writer, packer->buffer, packer->len);
+    packer->count = 0;
+}
+
+int osc_packer_init(osc_packer_t *packer, void *buffer, int len, int mtu, uint64_t max_latency, osc_packer_flush_cb flush, void *userdata) {
+    if (mtu < BUNDLE_HEADER_LEN + 4 || len < mtu) return OSC_ERROR;
+    packer->buffer      = (char*)buffer;
+    packer->len         = len;
+    packer->mtu         = mtu;
+    packer->max_latency = max_latency;
+    packer->flush       = flush;
+    packer->userdata    = userdata;
+    packer->timetag     = OSC_NOW;
+    packer->deadline    = 0;
+    packer->elem_start  = 0;
+    reset(packer);
+    return OSC_OK;
+}
+
+int osc_packer_flush(osc_packer_t *packer) {
+    if (packer->writer.state & OSC_WRITER_MSG) return OSC_ERROR;
+    if (packer->count > 0) {
+        osc_msg_writer_end_bundle(&packer->writer);
+        if (packer->count == 1 && packer->timetag == OSC_NOW) {
+            /* skip the bundle header and the element's size prefix */
+            packer->flush(packer->buffer + BUNDLE_HEADER_LEN + 4,
+                          packer->writer.pos - BUNDLE_HEADER_LEN - 4,
+                          packer->userdata);
+        } else {
+            packer->flush(packer->buffer, packer->writer.pos, packer->userdata);
+        }
+    }
+    reset(packer);
+    return OSC_OK;
+}
+
+int osc_packer_poll(osc_packer_t *packer, uint64_t now) {
+    if (packer->count > 0 && !(packer->writer.state & OSC_WRITER_MSG) && now >= packer->deadline) {
+        return osc_packer_flush(packer);
+    }
+    return OSC_OK;
+}
+
+/* make the current bundle ready to receive a message with `timetag` */
+static int prepare(osc_packer_t *packer, osc_timetag_t timetag, uint64_t now) {
+    if (packer->writer.state & OSC_WRITER_MSG) return OSC_ERROR;
+    if (packer->count > 0 && (timetag != packer->timetag || now >= packer->deadline)) {
+        osc_packer_flush(packer);
+    }
+    if (packer->count == 0) {
+        reset(packer);
+        if (osc_msg_writer_start_bundle(&packer->writer, timetag) != OSC_OK) return OSC_ERROR;
+        packer->timetag = timetag;
+        packer->deadline = now + packer->max_latency;
+    }
+    packer->elem_start = packer->writer.pos;
+    return OSC_OK;
+}
+
+/* account for the element just written, spilling it into a fresh bundle if it
+ * took the current one past the MTU */
+static int complete(osc_packer_t *packer, uint64_t now) {
+    packer->count++;
+
+    if (packer->writer.pos > packer->mtu && packer->count > 1) {
+        int elem_start = packer->elem_start;
+        int elem_len = packer->writer.pos - elem_start;
+
+        packer->writer.pos = elem_start;
+        packer->count--;
+        osc_packer_flush(packer);
+
+        osc_msg_writer_start_bundle(&packer->writer, packer->timetag);
+        memmove(packer->buffer + packer->writer.pos, packer->buffer + elem_start, elem_len);
+        packer->elem_start = packer->writer.pos;
+        packer->writer.pos += elem_len;
+        packer->count = 1;
+        packer->deadline = now + packer->max_latency;
+    }
+
+    if (packer->writer.pos >= packer->mtu || now >= packer->deadline) {
+        return osc_packer_flush(packer);
+    }
+
+    return OSC_OK;
+}
+
+osc_writer_t* osc_packer_start_msg(osc_packer_t *packer, osc_timetag_t timetag, const char *address, int nargs, uint64_t now) {
+    if (prepare(packer, timetag, now) != OSC_OK) return NULL;
+    if (osc_msg_writer_start_msg(&packer->writer, address, nargs) != OSC_OK) {
+        osc_packer_cancel_msg(packer);
+        return NULL;
+    }
+    return &packer->writer;
+}
+
+int osc_packer_end_msg(osc_packer_t *packer, uint64_t now) {
+    if (osc_msg_writer_end_msg(&packer->writer) != OSC_OK) return OSC_ERROR;
+    return complete(packer, now);
+}
+
+void osc_packer_cancel_msg(osc_packer_t *packer) {
+    packer->writer.pos = packer->elem_start;
+    packer->writer.state &= ~OSC_WRITER_MSG;
+    if (packer->count == 0) reset(packer);
+}
+
+int osc_packer_add(osc_packer_t *packer, osc_timetag_t timetag, const char *msg, int len, uint64_t now) {
+    if (len < 4 || (len & 3)) return OSC_ERROR;
+    if (prepare(packer, timetag, now) != OSC_OK) return OSC_ERROR;
+    if (osc_writer_reserve(&packer->writer, 4 + len) != OSC_OK) {
+        if (packer->count == 0) reset(packer);
+        return OSC_ERROR;
+    }
+    char *elem = packer->writer.data + packer->writer.pos;
+    *((uint32_t*)elem) = osc_hton32((uint32_t)len);
+    memcpy(elem + 4, msg, len);
+    packer->writer.pos += 4 + len;
+    return complete(packer, now);
+}
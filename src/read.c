@@ -7,7 +7,8 @@ int osc_packet_get_type(const char *buffer, int len) {
 
 int osc_bundle_reader_init(osc_bundle_reader_t *reader, const char *buffer, int len) {
     
-    if (len < 20) return OSC_ERROR;
+    /* header and timetag; a bundle may have no elements at all */
+    if (len < 16) return OSC_ERROR;
     
     reader->bundle_ptr  = buffer;
     reader->bundle_end  = buffer + len;
@@ -18,7 +19,8 @@ int osc_bundle_reader_init(osc_bundle_reader_t *reader, const char *buffer, int
 }
 
 osc_timetag_t osc_bundle_reader_get_timetag(osc_bundle_reader_t *reader) {
-    return *((osc_timetag_t*)(reader->bundle_ptr + 8));
+    osc_timetag_t raw = *((osc_timetag_t*)(reader->bundle_ptr + 8));
+    return osc_ntoh64(raw);
 }
 
 int osc_bundle_reader_next(osc_bundle_reader_t *reader, const char **start, int32_t *len) {
@@ -39,13 +41,58 @@ int osc_bundle_reader_next(osc_bundle_reader_t *reader, const char **start, int3
     
 }
 
+int osc_packet_walk(const char *buffer, int len, osc_packet_walk_cb cb, void *userdata) {
+    
+    osc_bundle_reader_t stack[OSC_WALK_MAX_DEPTH];
+    osc_timetag_t       timetags[OSC_WALK_MAX_DEPTH];
+    osc_msg_reader_t    reader;
+    int                 depth = 0;
+    
+    int type = osc_packet_get_type(buffer, len);
+    if (type == OSC_MESSAGE) {
+        if (osc_msg_reader_init(&reader, buffer, len) != OSC_OK) return OSC_ERROR;
+        return cb(&reader, OSC_NOW, userdata);
+    } else if (type != OSC_BUNDLE) {
+        return OSC_ERROR;
+    }
+    
+    if (osc_bundle_reader_init(&stack[0], buffer, len) != OSC_OK) return OSC_ERROR;
+    timetags[0] = osc_bundle_reader_get_timetag(&stack[0]);
+    depth = 1;
+    
+    while (depth > 0) {
+        const char *start;
+        int32_t elem_len;
+        type = osc_bundle_reader_next(&stack[depth - 1], &start, &elem_len);
+        if (type == OSC_END) {
+            depth--;
+        } else if (type == OSC_MESSAGE) {
+            if (osc_msg_reader_init(&reader, start, elem_len) != OSC_OK) return OSC_ERROR;
+            int ret = cb(&reader, timetags[depth - 1], userdata);
+            if (ret != OSC_OK) return ret;
+        } else if (type == OSC_BUNDLE) {
+            if (depth == OSC_WALK_MAX_DEPTH) return OSC_ERROR;
+            if (osc_bundle_reader_init(&stack[depth], start, elem_len) != OSC_OK) return OSC_ERROR;
+            timetags[depth] = osc_bundle_reader_get_timetag(&stack[depth]);
+            depth++;
+        } else {
+            return OSC_ERROR;
+        }
+    }
+    
+    return OSC_OK;
+    
+}
+
 int osc_msg_reader_init(osc_msg_reader_t *reader, const char *buffer, int len) {
     
     reader->msg_ptr = buffer;
     reader->msg_end = buffer + len;
     
-    int addr_len = ROUND32(strlen(reader->msg_ptr) + 1);
-    const char *type_ptr = reader->msg_ptr + addr_len;
+    int addr_len = osc_scan_nul(reader->msg_ptr, reader->msg_end);
+    if (addr_len < 0) return OSC_ERROR;
+    
+    const char *type_ptr = reader->msg_ptr + ROUND32(addr_len + 1);
     
     if (type_ptr > reader->msg_end) {
         return OSC_ERROR;
@@ -53,8 +100,9 @@ int osc_msg_reader_init(osc_msg_reader_t *reader, const char *buffer, int len) {
         reader->type_ptr = NULL;
         reader->arg_ptr = NULL;
     } else if (*type_ptr == ',') {
-        const char *arg_ptr = type_ptr + ROUND32(strlen(type_ptr) + 1);
-        if (arg_ptr > reader->msg_end) {
+        int type_len = osc_scan_nul(type_ptr, reader->msg_end);
+        const char *arg_ptr = type_ptr + ROUND32(type_len + 1);
+        if (type_len < 0 || arg_ptr > reader->msg_end) {
             return OSC_ERROR;
         } else {
             reader->type_ptr = type_ptr + 1; /* skip leading ',' */
@@ -65,6 +113,8 @@ int osc_msg_reader_init(osc_msg_reader_t *reader, const char *buffer, int len) {
         reader->arg_ptr = type_ptr;
     }
     
+    reader->type_start = reader->type_ptr;
+    
     return OSC_OK;
 }
 
@@ -76,6 +126,13 @@ const char *osc_msg_reader_get_address(osc_msg_reader_t *reader) {
     return reader->msg_ptr;
 }
 
+uint32_t osc_msg_reader_get_address_hash(osc_msg_reader_t *reader) {
+    /* init has already found the address's terminator within the message */
+    uint32_t hash;
+    osc_scan_nul_hash(reader->msg_ptr, reader->msg_end, &hash);
+    return hash;
+}
+
 int osc_msg_reader_get_arg(osc_msg_reader_t *reader, osc_arg_t *arg) {
     char t = osc_msg_reader_next_arg(reader);
     if (t < 0) return t;
@@ -112,6 +169,62 @@ char osc_msg_reader_next_arg(osc_msg_reader_t *reader) {
     }
 }
 
+int osc_msg_reader_index_args(osc_msg_reader_t *reader, int32_t *offsets, int max_args) {
+    
+    if (!reader->type_start) return OSC_ERROR;
+    
+    const char *type_ptr = reader->type_start;
+    
+    /* arguments start immediately after the padded type tag; init has already
+     * verified that it is terminated */
+    const char *arg_ptr = type_ptr - 1 + ROUND32(osc_scan_nul(type_ptr - 1, reader->msg_end) + 1);
+    
+    int ix = 0;
+    while (ix < max_args && *type_ptr) {
+        offsets[ix++] = (int32_t)(arg_ptr - reader->msg_ptr);
+        switch (*(type_ptr++)) {
+            case 'T':   /* fall through */
+            case 'F':   /* fall through */
+            case 'N':   /* fall through */
+            case 'I':   break;
+            case 'i':   /* fall through */
+            case 'f':   arg_ptr += 4; break;
+            case 'h':   /* fall through */
+            case 't':   /* fall through */
+            case 'd':   arg_ptr += 8; break;
+            case 'k':   /* fall through */
+            case 's':   /* fall through */
+            case 'S':
+            {
+                int len = osc_scan_nul(arg_ptr, reader->msg_end);
+                if (len < 0) return OSC_ERROR;
+                arg_ptr += ROUND32(len + 1);
+                break;
+            }
+            case 'b':
+            {
+                if (reader->msg_end - arg_ptr < 4) return OSC_ERROR;
+                osc_v32_t sz;
+                sz.u32 = osc_ntoh32(*((uint32_t*)arg_ptr));
+                if (sz.i32 < 0 || sz.i32 > reader->msg_end - arg_ptr) return OSC_ERROR;
+                arg_ptr += 4 + ROUND32(sz.i32);
+                break;
+            }
+            default:    return OSC_ERROR;
+        }
+        if (arg_ptr > reader->msg_end) return OSC_ERROR;
+    }
+    
+    return ix;
+    
+}
+
+char osc_msg_reader_seek_arg(osc_msg_reader_t *reader, const int32_t *offsets, int ix) {
+    reader->type_ptr = reader->type_start + ix + 1;
+    reader->arg_ptr = reader->msg_ptr + offsets[ix];
+    return reader->type_start[ix];
+}
+
 #define READ_FIXED(target, bits, union_member) \
     osc_v##bits##_t raw_val; \
     if (reader->msg_end - reader->arg_ptr < (int)sizeof(raw_val.union_member)) return OSC_ERROR; \
@@ -145,7 +258,9 @@ int osc_msg_reader_get_arg_double(osc_msg_reader_t *reader, double *val) {
 }
 
 int osc_msg_reader_get_arg_str(osc_msg_reader_t *reader, const char **val) {
-    int len = ROUND32(strlen(reader->arg_ptr) + 1);
+    int len = osc_scan_nul(reader->arg_ptr, reader->msg_end);
+    if (len < 0) return OSC_ERROR;
+    len = ROUND32(len + 1);
     if (reader->arg_ptr + len > reader->msg_end) return OSC_ERROR;
     *val = reader->arg_ptr;
     reader->arg_ptr += len;
@@ -160,3 +275,43 @@ int osc_msg_reader_get_arg_blob(osc_msg_reader_t *reader, void **val, int32_t *s
     reader->arg_ptr += rounded_sz;
     return OSC_OK;
 }
+
+static int read_run(osc_msg_reader_t *reader, char type, int width, void *vals, int max) {
+    
+    if (!reader->type_ptr) return OSC_ERROR;
+    
+    const char *type_ptr = reader->type_ptr;
+    const char *type_end = type_ptr + max;
+    while (type_ptr < type_end && *type_ptr == type) type_ptr++;
+    
+    int count = type_ptr - reader->type_ptr;
+    if (reader->msg_end - reader->arg_ptr < count * width) return OSC_ERROR;
+    
+    if (width == 4) {
+        osc_swap32(vals, reader->arg_ptr, count);
+    } else {
+        osc_swap64(vals, reader->arg_ptr, count);
+    }
+    
+    reader->type_ptr = type_ptr;
+    reader->arg_ptr += count * width;
+    
+    return count;
+    
+}
+
+int osc_msg_reader_get_int32_array(osc_msg_reader_t *reader, int32_t *vals, int max) {
+    return read_run(reader, 'i', 4, vals, max);
+}
+
+int osc_msg_reader_get_int64_array(osc_msg_reader_t *reader, int64_t *vals, int max) {
+    return read_run(reader, 'h', 8, vals, max);
+}
+
+int osc_msg_reader_get_float_array(osc_msg_reader_t *reader, float *vals, int max) {
+    return read_run(reader, 'f', 4, vals, max);
+}
+
+int osc_msg_reader_get_double_array(osc_msg_reader_t *reader, double *vals, int max) {
+    return read_run(reader, 'd', 8, vals, max);
+}
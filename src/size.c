@@ -0,0 +1,43 @@
+#include "little-oscar/osc_internal.h"
+
+int osc_str_size(const char *str) {
+    return ROUND32(strlen(str) + 1);
+}
+
+int osc_blob_size(int32_t sz) {
+    return 4 + ROUND32(sz);
+}
+
+int osc_msg_size(const char *address, const char *typetag, int var_len) {
+
+    if (*typetag == ',') typetag++;
+
+    int nargs = 0;
+    int fixed_len = 0;
+    while (typetag[nargs]) {
+        switch (typetag[nargs]) {
+            case 'T':   /* fall through */
+            case 'F':   /* fall through */
+            case 'N':   /* fall through */
+            case 'I':   /* fall through */
+            case 'k':   /* fall through */
+            case 's':   /* fall through */
+            case 'S':   /* fall through */
+            case 'b':   break;
+            case 'i':   /* fall through */
+            case 'f':   fixed_len += 4; break;
+            case 'h':   /* fall through */
+            case 't':   /* fall through */
+            case 'd':   fixed_len += 8; break;
+            default:    return OSC_ERROR;
+        }
+        nargs++;
+    }
+
+    return osc_str_size(address) + ROUND32(nargs + 2) + fixed_len + var_len;
+
+}
+
+int osc_bundle_size(int count, int elems_len) {
+    return 16 + (4 * count) + elems_len;
+}
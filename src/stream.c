@@ -0,0 +1,207 @@
+#include "little-oscar/osc_internal.h"
+
+#define SLIP_END        ((char)0xC0)
+#define SLIP_ESC        ((char)0xDB)
+#define SLIP_ESC_END    ((char)0xDC)
+#define SLIP_ESC_ESC    ((char)0xDD)
+
+#define RING_IX(s, i)   (((s)->head + (i)) % (s)->cap)
+
+int osc_stream_init(osc_stream_t *stream, int framing, void *buffer, int len, void *scratch, int scratch_len) {
+    if (framing != OSC_STREAM_SIZE_PREFIX && framing != OSC_STREAM_SLIP) return OSC_ERROR;
+    if (len < 4) return OSC_ERROR;
+    stream->buffer      = (char*)buffer;
+    stream->cap         = len;
+    stream->head        = 0;
+    stream->len         = 0;
+    stream->scanned     = 0;
+    stream->release     = 0;
+    stream->scratch     = (char*)scratch;
+    stream->scratch_len = scratch ? scratch_len : 0;
+    stream->framing     = framing;
+    stream->skipping    = 0;
+    return OSC_OK;
+}
+
+static void consume(osc_stream_t *stream, int len) {
+    stream->len -= len;
+    stream->scanned = (stream->scanned > len) ? (stream->scanned - len) : 0;
+    /* an empty ring restarts at the beginning so later packets are less
+     * likely to wrap */
+    stream->head = stream->len ? RING_IX(stream, len) : 0;
+}
+
+int osc_stream_write_ptr(osc_stream_t *stream, char **ptr) {
+    int tail = RING_IX(stream, stream->len);
+    *ptr = stream->buffer + tail;
+    if (stream->len == stream->cap) {
+        return 0;
+    } else if (tail >= stream->head) {
+        return stream->cap - tail;
+    } else {
+        return stream->head - tail;
+    }
+}
+
+void osc_stream_commit(osc_stream_t *stream, int len) {
+    stream->len += len;
+}
+
+int osc_stream_feed(osc_stream_t *stream, const char *data, int len) {
+    int accepted = 0;
+    while (accepted < len) {
+        char *ptr;
+        int avail = osc_stream_write_ptr(stream, &ptr);
+        if (avail == 0) break;
+        if (avail > len - accepted) avail = len - accepted;
+        memcpy(ptr, data + accepted, avail);
+        osc_stream_commit(stream, avail);
+        accepted += avail;
+    }
+    return accepted;
+}
+
+/* copy `len` bytes starting at ring offset `offset` into `dest` */
+static void copy_out(osc_stream_t *stream, char *dest, int offset, int len) {
+    int start = RING_IX(stream, offset);
+    int first = stream->cap - start;
+    if (first > len) first = len;
+    memcpy(dest, stream->buffer + start, first);
+    memcpy(dest + first, stream->buffer, len - first);
+}
+
+static int next_size_prefixed(osc_stream_t *stream, const char **packet, int *len) {
+
+    if (stream->len < 4) return OSC_END;
+
+    uint32_t raw;
+    copy_out(stream, (char*)&raw, 0, 4);
+    osc_v32_t sz;
+    sz.u32 = osc_ntoh32(raw);
+
+    /* packets, along with their prefix, must fit in the ring */
+    if (sz.i32 < 0 || sz.i32 > stream->cap - 4) return OSC_ERROR;
+    if (stream->len - 4 < sz.i32) return OSC_END;
+
+    int start = RING_IX(stream, 4);
+    if (start + sz.i32 <= stream->cap) {
+        *packet = stream->buffer + start;
+    } else if (sz.i32 <= stream->scratch_len) {
+        copy_out(stream, stream->scratch, 4, sz.i32);
+        *packet = stream->scratch;
+    } else {
+        return OSC_ERROR;
+    }
+
+    *len = sz.i32;
+    stream->release = 4 + sz.i32;
+
+    return OSC_OK;
+
+}
+
+/* SLIP-decode `len` bytes from `src` into `dest`, which may alias `src` */
+static int slip_decode(char *dest, const char *src, int len) {
+    char *out = dest;
+    const char *end = src + len;
+    while (src < end) {
+        char c = *(src++);
+        if (c == SLIP_ESC) {
+            if (src == end) return OSC_ERROR;
+            c = *(src++);
+            if (c == SLIP_ESC_END) {
+                c = SLIP_END;
+            } else if (c == SLIP_ESC_ESC) {
+                c = SLIP_ESC;
+            } else {
+                return OSC_ERROR;
+            }
+        }
+        *(out++) = c;
+    }
+    return (int)(out - dest);
+}
+
+static int next_slip(osc_stream_t *stream, const char **packet, int *len) {
+
+    while (1) {
+
+        /* resume scanning for the frame delimiter where we last left off,
+         * one contiguous segment of the ring at a time */
+        int frame_len = -1;
+        while (frame_len < 0 && stream->scanned < stream->len) {
+            const char *seg = stream->buffer + RING_IX(stream, stream->scanned);
+            const char *seg_end = seg + (stream->len - stream->scanned);
+            if (seg_end > stream->buffer + stream->cap) seg_end = stream->buffer + stream->cap;
+            const char *p = seg;
+            while (p < seg_end && *p != SLIP_END) p++;
+            stream->scanned += (int)(p - seg);
+            if (p < seg_end) frame_len = stream->scanned;
+        }
+
+        if (frame_len < 0) {
+            if (stream->skipping) {
+                /* still inside the oversized frame; it has already been reported */
+                consume(stream, stream->len);
+                return OSC_END;
+            } else if (stream->len == stream->cap) {
+                /* the frame can never fit: drop what we have and resync at
+                 * the next END */
+                consume(stream, stream->len);
+                stream->skipping = 1;
+                return OSC_ERROR;
+            }
+            return OSC_END;
+        }
+
+        /* the END that finishes an oversized frame */
+        if (stream->skipping) {
+            consume(stream, frame_len + 1);
+            stream->skipping = 0;
+            continue;
+        }
+
+        /* leading END bytes delimit empty frames; skip them */
+        if (frame_len == 0) {
+            consume(stream, 1);
+            continue;
+        }
+
+        stream->release = frame_len + 1;
+
+        int decoded;
+        if (stream->head + frame_len <= stream->cap) {
+            char *frame = stream->buffer + stream->head;
+            decoded = slip_decode(frame, frame, frame_len);
+            *packet = frame;
+        } else if (frame_len <= stream->scratch_len) {
+            copy_out(stream, stream->scratch, 0, frame_len);
+            decoded = slip_decode(stream->scratch, stream->scratch, frame_len);
+            *packet = stream->scratch;
+        } else {
+            return OSC_ERROR;
+        }
+
+        if (decoded < 0) return OSC_ERROR;
+
+        *len = decoded;
+        return OSC_OK;
+
+    }
+
+}
+
+int osc_stream_next(osc_stream_t *stream, const char **packet, int *len) {
+
+    if (stream->release) {
+        consume(stream, stream->release);
+        stream->release = 0;
+    }
+
+    if (stream->framing == OSC_STREAM_SLIP) {
+        return next_slip(stream, packet, len);
+    } else {
+        return next_size_prefixed(stream, packet, len);
+    }
+
+}
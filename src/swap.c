@@ -0,0 +1,126 @@
+#include "little-oscar/osc_internal.h"
+
+/*
+ * Bulk conversion between host and network byte order.
+ *
+ * Byte-swapping is its own inverse so these serve both directions. Vector
+ * paths are selected at compile time: a byte shuffle with -mssse3/-mavx2,
+ * otherwise shifts plus word shuffles on plain SSE2. Other targets fall back to
+ * osc_ntoh32()/osc_ntoh64() per element.
+ */
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define OSC_SWAP_AVX2
+    #define OSC_SWAP_SSSE3
+#elif defined(__SSSE3__)
+    #include <tmmintrin.h>
+    #define OSC_SWAP_SSSE3
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define OSC_SWAP_SSE2
+#endif
+
+#if defined(OSC_SWAP_SSE2)
+/* swap the bytes of each 16-bit lane */
+static inline __m128i swap16_sse2(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+#endif
+
+#define HOST_IS_NETWORK_ORDER() (osc_hton32(1) == 1)
+
+void osc_swap32(void *dst, const void *src, int count) {
+
+    const char *s = (const char*)src;
+    char *d = (char*)dst;
+
+    if (HOST_IS_NETWORK_ORDER()) {
+        int n = count * 4;
+        while (n--) *(d++) = *(s++);
+        return;
+    }
+
+#if defined(OSC_SWAP_AVX2)
+    const __m256i mask256 = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                             3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    while (count >= 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)s);
+        _mm256_storeu_si256((__m256i*)d, _mm256_shuffle_epi8(v, mask256));
+        s += 32; d += 32; count -= 8;
+    }
+#endif
+
+#if defined(OSC_SWAP_SSSE3)
+    const __m128i mask128 = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    while (count >= 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)s);
+        _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi8(v, mask128));
+        s += 16; d += 16; count -= 4;
+    }
+#elif defined(OSC_SWAP_SSE2)
+    while (count >= 4) {
+        __m128i v = swap16_sse2(_mm_loadu_si128((const __m128i*)s));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+        _mm_storeu_si128((__m128i*)d, v);
+        s += 16; d += 16; count -= 4;
+    }
+#endif
+
+    /* memcpy, since neither pointer need be aligned */
+    while (count--) {
+        uint32_t v;
+        memcpy(&v, s, 4);
+        v = osc_ntoh32(v);
+        memcpy(d, &v, 4);
+        s += 4; d += 4;
+    }
+
+}
+
+void osc_swap64(void *dst, const void *src, int count) {
+
+    const char *s = (const char*)src;
+    char *d = (char*)dst;
+
+    if (HOST_IS_NETWORK_ORDER()) {
+        int n = count * 8;
+        while (n--) *(d++) = *(s++);
+        return;
+    }
+
+#if defined(OSC_SWAP_AVX2)
+    const __m256i mask256 = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                             7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    while (count >= 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)s);
+        _mm256_storeu_si256((__m256i*)d, _mm256_shuffle_epi8(v, mask256));
+        s += 32; d += 32; count -= 4;
+    }
+#endif
+
+#if defined(OSC_SWAP_SSSE3)
+    const __m128i mask128 = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    while (count >= 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)s);
+        _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi8(v, mask128));
+        s += 16; d += 16; count -= 2;
+    }
+#elif defined(OSC_SWAP_SSE2)
+    while (count >= 2) {
+        __m128i v = swap16_sse2(_mm_loadu_si128((const __m128i*)s));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);
+        _mm_storeu_si128((__m128i*)d, v);
+        s += 16; d += 16; count -= 2;
+    }
+#endif
+
+    while (count--) {
+        uint64_t v;
+        memcpy(&v, s, 8);
+        v = osc_ntoh64(v);
+        memcpy(d, &v, 8);
+        s += 8; d += 8;
+    }
+
+}
@@ -0,0 +1,78 @@
+#include "little-oscar/osc_internal.h"
+
+int osc_msg_template_init(osc_msg_template_t *tpl, void *buffer, int len, const char *address, const char *typetag) {
+
+    if (*typetag == ',') typetag++;
+
+    int nargs = strlen(typetag);
+    if (nargs > OSC_TEMPLATE_MAX_ARGS) return OSC_ERROR;
+
+    /* encode with zeroed arguments, recording where each value lands */
+    osc_writer_t writer;
+    osc_msg_writer_init(&writer, buffer, len);
+    if (osc_msg_writer_start_msg(&writer, address, nargs) != OSC_OK) return OSC_ERROR;
+
+    int ix, ret;
+    for (ix = 0; ix < nargs; ix++) {
+        tpl->offsets[ix] = writer.pos;
+        switch (typetag[ix]) {
+            case 'T':   ret = osc_msg_write_true(&writer); break;
+            case 'F':   ret = osc_msg_write_false(&writer); break;
+            case 'N':   ret = osc_msg_write_null(&writer); break;
+            case 'I':   ret = osc_msg_write_infinity(&writer); break;
+            case 'i':   ret = osc_msg_write_int32(&writer, 0); break;
+            case 'h':   ret = osc_msg_write_int64(&writer, 0); break;
+            case 't':   ret = osc_msg_write_timetag(&writer, 0); break;
+            case 'f':   ret = osc_msg_write_float(&writer, 0); break;
+            case 'd':   ret = osc_msg_write_double(&writer, 0); break;
+            default:    return OSC_ERROR;
+        }
+        if (ret != OSC_OK) return OSC_ERROR;
+    }
+
+    if (osc_msg_writer_end_msg(&writer) != OSC_OK) return OSC_ERROR;
+
+    tpl->data   = (char*)buffer;
+    tpl->len    = writer.pos;
+    tpl->nargs  = nargs;
+
+    return OSC_OK;
+
+}
+
+#define SET_FIXED(bits, union_member) \
+    osc_v##bits##_t raw_val; \
+    raw_val.union_member = val; \
+    *((uint##bits##_t*)(tpl->data + tpl->offsets[ix])) = osc_hton##bits(raw_val.u##bits);
+
+void osc_msg_template_set_int32(osc_msg_template_t *tpl, int ix, int32_t val) {
+    SET_FIXED(32, i32);
+}
+
+void osc_msg_template_set_int64(osc_msg_template_t *tpl, int ix, int64_t val) {
+    SET_FIXED(64, i64);
+}
+
+void osc_msg_template_set_timetag(osc_msg_template_t *tpl, int ix, osc_timetag_t val) {
+    SET_FIXED(64, timetag);
+}
+
+void osc_msg_template_set_float(osc_msg_template_t *tpl, int ix, float val) {
+    SET_FIXED(32, fl);
+}
+
+void osc_msg_template_set_double(osc_msg_template_t *tpl, int ix, double val) {
+    SET_FIXED(64, fl);
+}
+
+int osc_msg_template_copy(const osc_msg_template_t *tpl, void *buffer, int len) {
+    if (len < tpl->len) return OSC_ERROR;
+    memcpy(buffer, tpl->data, tpl->len);
+    return tpl->len;
+}
+
+int osc_msg_writer_write_template(osc_writer_t *writer, const osc_msg_template_t *tpl) {
+    if (osc_writer_open_msg(writer, tpl->len) != OSC_OK) return OSC_ERROR;
+    if (!writer->sizing) memcpy(writer->data + writer->msg_start, tpl->data, tpl->len);
+    return osc_msg_writer_end_msg(writer);
+}
@@ -0,0 +1,189 @@
+#include "little-oscar/osc_internal.h"
+
+static int validate_msg(const char *msg_ptr, const char *msg_end) {
+
+    int len = osc_scan_nul(msg_ptr, msg_end);
+    if (len < 0) return OSC_ERROR;
+
+    const char *type_ptr = msg_ptr + ROUND32(len + 1);
+    if (type_ptr > msg_end) return OSC_ERROR;
+    if (type_ptr == msg_end) return OSC_OK;
+
+    /* untyped arguments can't be sized, and hence can't be trusted */
+    if (*type_ptr != ',') return OSC_ERROR;
+
+    len = osc_scan_nul(type_ptr, msg_end);
+    if (len < 0) return OSC_ERROR;
+
+    const char *arg_ptr = type_ptr + ROUND32(len + 1);
+    if (arg_ptr > msg_end) return OSC_ERROR;
+
+    while (*(++type_ptr)) {
+        switch (*type_ptr) {
+            case 'T':   /* fall through */
+            case 'F':   /* fall through */
+            case 'N':   /* fall through */
+            case 'I':   break;
+            case 'i':   /* fall through */
+            case 'f':   arg_ptr += 4; break;
+            case 'h':   /* fall through */
+            case 't':   /* fall through */
+            case 'd':   arg_ptr += 8; break;
+            case 'k':   /* fall through */
+            case 's':   /* fall through */
+            case 'S':
+            {
+                len = osc_scan_nul(arg_ptr, msg_end);
+                if (len < 0) return OSC_ERROR;
+                arg_ptr += ROUND32(len + 1);
+                break;
+            }
+            case 'b':
+            {
+                if (msg_end - arg_ptr < 4) return OSC_ERROR;
+                osc_v32_t sz;
+                sz.u32 = osc_ntoh32(*((uint32_t*)arg_ptr));
+                if (sz.i32 < 0 || sz.i32 > msg_end - arg_ptr) return OSC_ERROR;
+                arg_ptr += 4 + ROUND32(sz.i32);
+                break;
+            }
+            default:    return OSC_ERROR;
+        }
+        if (arg_ptr > msg_end) return OSC_ERROR;
+    }
+
+    /* arguments must account for the message exactly */
+    return (arg_ptr == msg_end) ? OSC_OK : OSC_ERROR;
+
+}
+
+int osc_packet_validate(const char *buffer, int len) {
+
+    const char  *ptrs[OSC_WALK_MAX_DEPTH];
+    const char  *ends[OSC_WALK_MAX_DEPTH];
+    int         depth = 0;
+
+    const char  *elem = buffer;
+    int32_t     elem_len = len;
+
+    while (1) {
+        int type = osc_packet_get_type(elem, elem_len);
+        if (type == OSC_MESSAGE) {
+            if (validate_msg(elem, elem + elem_len) != OSC_OK) return OSC_ERROR;
+        } else if (type == OSC_BUNDLE) {
+            if (depth == OSC_WALK_MAX_DEPTH) return OSC_ERROR;
+            if (elem_len < 16 || memcmp(elem, "#bundle", 8) != 0) return OSC_ERROR;
+            ptrs[depth] = elem + 16;
+            ends[depth] = elem + elem_len;
+            depth++;
+        } else {
+            return OSC_ERROR;
+        }
+
+        /* advance to the next element, popping finished bundles */
+        while (depth > 0 && ptrs[depth - 1] == ends[depth - 1]) depth--;
+        if (depth == 0) return OSC_OK;
+
+        const char *ptr = ptrs[depth - 1];
+        if (ends[depth - 1] - ptr < 4) return OSC_ERROR;
+
+        osc_v32_t sz;
+        sz.u32 = osc_ntoh32(*((uint32_t*)ptr));
+        if (sz.i32 < 0 || sz.i32 > ends[depth - 1] - ptr - 4) return OSC_ERROR;
+
+        elem = ptr + 4;
+        elem_len = sz.i32;
+        ptrs[depth - 1] = elem + elem_len;
+    }
+
+}
+
+/* Unchecked reader */
+
+int osc_msg_reader_init_unchecked(osc_msg_reader_t *reader, const char *buffer, int len) {
+
+    reader->msg_ptr = buffer;
+    reader->msg_end = buffer + len;
+
+    int addr_len = osc_scan_nul(buffer, reader->msg_end);
+    const char *type_ptr = buffer + ROUND32(addr_len + 1);
+
+    if (type_ptr == reader->msg_end) {
+        reader->type_ptr = NULL;
+        reader->arg_ptr = NULL;
+    } else {
+        reader->type_ptr = type_ptr + 1; /* skip leading ',' */
+        reader->arg_ptr = type_ptr + ROUND32(strlen(type_ptr) + 1);
+    }
+
+    reader->type_start = reader->type_ptr;
+
+    return OSC_OK;
+
+}
+
+int osc_msg_reader_get_arg_unchecked(osc_msg_reader_t *reader, osc_arg_t *arg) {
+    char t = osc_msg_reader_next_arg(reader);
+    if (t < 0) return t;
+    arg->type = t;
+    switch (t) {
+        case 'T':   /* fall through */
+        case 'F':   /* fall through */
+        case 'N':   /* fall through */
+        case 'I':   return OSC_OK;
+        case 'i':   return osc_msg_reader_get_arg_int32_unchecked(reader, &arg->val.val_int32);
+        case 'h':   return osc_msg_reader_get_arg_int64_unchecked(reader, &arg->val.val_int64);
+        case 't':   return osc_msg_reader_get_arg_timetag_unchecked(reader, &arg->val.val_timetag);
+        case 'f':   return osc_msg_reader_get_arg_float_unchecked(reader, &arg->val.val_float);
+        case 'd':   return osc_msg_reader_get_arg_double_unchecked(reader, &arg->val.val_double);
+        case 'k':   /* fall through */
+        case 's':   /* fall through */
+        case 'S':   return osc_msg_reader_get_arg_str_unchecked(reader, &arg->val.val_str);
+        case 'b':   return osc_msg_reader_get_arg_blob_unchecked(reader, &arg->val.val_blob.data, &arg->val.val_blob.len);
+        default:    return OSC_ERROR;
+    }
+}
+
+#define READ_FIXED_UNCHECKED(target, bits, union_member) \
+    osc_v##bits##_t raw_val; \
+    raw_val.u##bits = osc_ntoh##bits(*((uint##bits##_t*)reader->arg_ptr)); \
+    *target = raw_val.union_member; \
+    reader->arg_ptr += sizeof(raw_val.union_member);
+
+int osc_msg_reader_get_arg_int32_unchecked(osc_msg_reader_t *reader, int32_t *val) {
+    READ_FIXED_UNCHECKED(val, 32, i32);
+    return OSC_OK;
+}
+
+int osc_msg_reader_get_arg_int64_unchecked(osc_msg_reader_t *reader, int64_t *val) {
+    READ_FIXED_UNCHECKED(val, 64, i64);
+    return OSC_OK;
+}
+
+int osc_msg_reader_get_arg_timetag_unchecked(osc_msg_reader_t *reader, osc_timetag_t *val) {
+    READ_FIXED_UNCHECKED(val, 64, timetag);
+    return OSC_OK;
+}
+
+int osc_msg_reader_get_arg_float_unchecked(osc_msg_reader_t *reader, float *val) {
+    READ_FIXED_UNCHECKED(val, 32, fl);
+    return OSC_OK;
+}
+
+int osc_msg_reader_get_arg_double_unchecked(osc_msg_reader_t *reader, double *val) {
+    READ_FIXED_UNCHECKED(val, 64, fl);
+    return OSC_OK;
+}
+
+int osc_msg_reader_get_arg_str_unchecked(osc_msg_reader_t *reader, const char **val) {
+    *val = reader->arg_ptr;
+    reader->arg_ptr += ROUND32(strlen(reader->arg_ptr) + 1);
+    return OSC_OK;
+}
+
+int osc_msg_reader_get_arg_blob_unchecked(osc_msg_reader_t *reader, void **val, int32_t *sz) {
+    READ_FIXED_UNCHECKED(sz, 32, i32);
+    *val = (void*) reader->arg_ptr;
+    reader->arg_ptr += ROUND32(*sz);
+    return OSC_OK;
+}
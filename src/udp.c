@@ -0,0 +1,125 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     /* recvmmsg() */
+#endif
+
+#include "little-oscar/osc_udp.h"
+#include "little-oscar/osc_internal.h"
+
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+    #define OSC_HAVE_RECVMMSG
+#endif
+
+#ifndef OSC_HAVE_RECVMMSG
+struct mmsghdr {
+    struct msghdr   msg_hdr;
+    unsigned int    msg_len;
+};
+#endif
+
+/* keep each packet buffer on its own cache lines */
+#define SLOT_ALIGN(i) (((i) + 63) & ~63)
+
+int osc_udp_receiver_init(osc_udp_receiver_t *rx, int fd, int batch, int packet_size) {
+
+    if (batch < 1 || packet_size < 4) return OSC_ERROR;
+
+    rx->fd          = fd;
+    rx->batch       = batch;
+    rx->packet_size = packet_size;
+    rx->slot_size   = SLOT_ALIGN(packet_size);
+    rx->slab        = malloc((size_t)rx->slot_size * batch);
+    rx->msgs        = calloc(batch, sizeof(struct mmsghdr));
+    rx->iovs        = calloc(batch, sizeof(struct iovec));
+    rx->addrs       = calloc(batch, sizeof(struct sockaddr_storage));
+
+    if (!rx->slab || !rx->msgs || !rx->iovs || !rx->addrs) {
+        osc_udp_receiver_teardown(rx);
+        return OSC_ERROR;
+    }
+
+    struct mmsghdr *msgs = (struct mmsghdr*)rx->msgs;
+    struct iovec *iovs = (struct iovec*)rx->iovs;
+    int i;
+    for (i = 0; i < batch; i++) {
+        iovs[i].iov_base = rx->slab + (size_t)i * rx->slot_size;
+        iovs[i].iov_len  = packet_size;
+        msgs[i].msg_hdr.msg_iov     = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen  = 1;
+        msgs[i].msg_hdr.msg_name    = &rx->addrs[i];
+    }
+
+    return OSC_OK;
+
+}
+
+void osc_udp_receiver_teardown(osc_udp_receiver_t *rx) {
+    free(rx->slab);
+    free(rx->msgs);
+    free(rx->iovs);
+    free(rx->addrs);
+    rx->slab    = NULL;
+    rx->msgs    = NULL;
+    rx->iovs    = NULL;
+    rx->addrs   = NULL;
+}
+
+#ifdef OSC_HAVE_RECVMMSG
+
+static int receive_batch(osc_udp_receiver_t *rx) {
+    struct mmsghdr *msgs = (struct mmsghdr*)rx->msgs;
+    int i;
+    for (i = 0; i < rx->batch; i++) {
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        msgs[i].msg_hdr.msg_flags   = 0;
+    }
+    int n;
+    do {
+        n = recvmmsg(rx->fd, msgs, rx->batch, MSG_WAITFORONE, NULL);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+#else
+
+static int receive_batch(osc_udp_receiver_t *rx) {
+    struct mmsghdr *msgs = (struct mmsghdr*)rx->msgs;
+    int n = 0;
+    while (n < rx->batch) {
+        struct msghdr *hdr = &msgs[n].msg_hdr;
+        hdr->msg_namelen    = sizeof(struct sockaddr_storage);
+        hdr->msg_flags      = 0;
+        ssize_t len = recvmsg(rx->fd, hdr, n ? MSG_DONTWAIT : 0);
+        if (len < 0) {
+            if (errno == EINTR && n == 0) continue;
+            if (n > 0) break;
+            return OSC_ERROR;
+        }
+        msgs[n++].msg_len = (unsigned int)len;
+    }
+    return n;
+}
+
+#endif
+
+int osc_udp_receiver_poll(osc_udp_receiver_t *rx, osc_udp_packet_cb cb, void *userdata) {
+
+    int n = receive_batch(rx);
+    if (n < 0) return OSC_ERROR;
+
+    struct mmsghdr *msgs = (struct mmsghdr*)rx->msgs;
+    int i;
+    for (i = 0; i < n; i++) {
+        struct msghdr *hdr = &msgs[i].msg_hdr;
+        if (hdr->msg_flags & MSG_TRUNC) continue;
+        cb((const char*)hdr->msg_iov->iov_base, (int)msgs[i].msg_len,
+           (const struct sockaddr*)hdr->msg_name, hdr->msg_namelen,
+           userdata);
+    }
+
+    return n;
+
+}
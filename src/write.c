@@ -10,41 +10,92 @@ typedef union {
     
 } union64;
 
+/* sizing writers only count bytes */
+#define SIZING() (writer->sizing)
+
 #define PAD() \
-    while (writer->pos & 3) { writer->data[writer->pos++] = '\0'; }
+    if (SIZING()) { writer->pos = ROUND32(writer->pos); } \
+    else while (writer->pos & 3) { writer->data[writer->pos++] = '\0'; }
 
 #define ENSURE_REMAIN(rlen) \
-    if (writer->len - writer->pos < (rlen)) { return OSC_ERROR; }
+    if (writer->len - writer->pos < (rlen) && osc_writer_reserve(writer, (rlen)) != OSC_OK) { return OSC_ERROR; }
 
 #define WRITE_STRING(str) \
-    while (*str) { writer->data[writer->pos++] = *(str++); } \
-    writer->data[writer->pos++] = '\0'; \
-    PAD();
+    if (SIZING()) { writer->pos += ROUND32(strlen(str) + 1); } \
+    else { \
+        while (*str) { writer->data[writer->pos++] = *(str++); } \
+        writer->data[writer->pos++] = '\0'; \
+        PAD(); \
+    }
 
 #define WRITE_FIXED(type, bits, val) \
-    uint##bits##_t raw = osc_hton##bits(val); \
-    *((uint##bits##_t*)(&(writer->data[writer->pos]))) = raw; \
+    if (!SIZING()) { \
+        union { type v; uint##bits##_t u; } conv; \
+        conv.v = (val); \
+        uint##bits##_t raw = osc_hton##bits(conv.u); \
+        *((uint##bits##_t*)(&(writer->data[writer->pos]))) = raw; \
+    } \
     writer->pos += sizeof(type)
 
 #define WRITE_FIXED_VA(type, va_type, bits) \
     type real_val = (type) va_arg(args, va_type); \
     WRITE_FIXED(type, bits, real_val)
 
-#define ADD_TYPE(t) writer->data[writer->type_pos++] = t
+#define ADD_TYPE(t) \
+    if (!SIZING()) { writer->data[writer->type_pos] = t; } \
+    writer->type_pos++
 
 static const char *k_bundle = "#bundle";
+static const char k_zero_pad[4] = { 0, 0, 0, 0 };
+
+static void reset_writer(osc_writer_t *writer) {
+    writer->pos = 0;
+    writer->grow = NULL;
+    writer->grow_userdata = NULL;
+    writer->iov = NULL;
+    writer->iov_max = 0;
+    writer->iov_count = 0;
+    writer->iov_mark = 0;
+    writer->ext_len = 0;
+    writer->msg_ext_start = 0;
+    writer->sizing = 0;
+    writer->depth = 0;
+    writer->state = OSC_WRITER_OUT;
+}
 
 int osc_msg_writer_init(osc_writer_t *writer, void *buffer_or_writer, int len) {
-    if (len > 0) {
+    int sizing = 0;
+    if (!buffer_or_writer) {
+        writer->data = NULL;
+        writer->len = 0x7fffffff;
+        sizing = 1;
+    } else if (len > 0) {
         writer->data = (char*)buffer_or_writer;
         writer->len = len;
     } else {
         osc_writer_t *parent = (osc_writer_t *)buffer_or_writer;
-        writer->data = parent->data + parent->pos;
+        writer->data = parent->sizing ? NULL : parent->data + parent->pos;
         writer->len  = parent->len - parent->pos;
+        sizing = parent->sizing;
     }
-    writer->pos = 0;
-    writer->state = OSC_WRITER_OUT;
+    reset_writer(writer);
+    writer->sizing = sizing;
+    return OSC_OK;
+}
+
+int osc_writer_reserve(osc_writer_t *writer, int rlen) {
+    if (writer->len - writer->pos >= rlen) return OSC_OK;
+    if (!writer->grow) return OSC_ERROR;
+    if (writer->grow(writer, writer->pos + rlen, writer->grow_userdata) != OSC_OK) return OSC_ERROR;
+    return (writer->len - writer->pos >= rlen) ? OSC_OK : OSC_ERROR;
+}
+
+int osc_msg_writer_init_growable(osc_writer_t *writer, void *buffer, int len, osc_writer_grow_fn grow, void *userdata) {
+    writer->data = (char*)buffer;
+    writer->len = len;
+    reset_writer(writer);
+    writer->grow = grow;
+    writer->grow_userdata = userdata;
     return OSC_OK;
 }
 
@@ -52,28 +103,66 @@ int osc_msg_writer_start_msg(osc_writer_t *writer, const char *address, int narg
     if (writer->state & OSC_WRITER_MSG) return OSC_ERROR;
     
     if (writer->state == OSC_WRITER_BUNDLE) {
+        ENSURE_REMAIN(4);
         writer->pos += 4;
     }
     
     writer->msg_start = writer->pos;
+    writer->msg_ext_start = writer->ext_len;
     
-    ENSURE_REMAIN(ROUND32(strlen(address)));
+    ENSURE_REMAIN(ROUND32(strlen(address) + 1));
     WRITE_STRING(address);
     
-    nargs = ROUND32(nargs);
-    ENSURE_REMAIN(nargs);
-    writer->type_pos = writer->pos;
-    while (nargs--) writer->data[writer->pos++] = '\0';
+    /* leading ',', one tag per argument, then NUL padding */
+    int type_len = ROUND32(nargs + 2);
+    ENSURE_REMAIN(type_len);
+    if (!SIZING()) {
+        writer->data[writer->pos] = ',';
+        memset(writer->data + writer->pos + 1, '\0', type_len - 1);
+    }
+    writer->type_pos = writer->pos + 1;
+    writer->pos += type_len;
     
     writer->state |= OSC_WRITER_MSG;
     
     return OSC_OK;
 }
 
+int osc_writer_open_msg(osc_writer_t *writer, int len) {
+    if (writer->state & OSC_WRITER_MSG) return OSC_ERROR;
+    if (!(writer->state & (OSC_WRITER_OUT | OSC_WRITER_BUNDLE))) return OSC_ERROR;
+    if (len < 4 || (len & 3)) return OSC_ERROR;
+
+    int prefix = (writer->state == OSC_WRITER_BUNDLE) ? 4 : 0;
+    if (osc_writer_reserve(writer, prefix + len) != OSC_OK) return OSC_ERROR;
+
+    writer->pos += prefix;
+    writer->msg_start = writer->pos;
+    writer->msg_ext_start = writer->ext_len;
+    writer->pos += len;
+    writer->state |= OSC_WRITER_MSG;
+
+    return OSC_OK;
+}
+
+char* osc_msg_writer_reserve_msg(osc_writer_t *writer, int len) {
+    /* sizing writers have nowhere to put the message */
+    if (SIZING()) return NULL;
+    if (osc_writer_open_msg(writer, len) != OSC_OK) return NULL;
+    return writer->data + writer->msg_start;
+}
+
+/* fill in the size prefix of the element starting at `start` */
+static void patch_size(osc_writer_t *writer, int start, int ext_start) {
+    if (SIZING()) return;
+    uint32_t elem_len = writer->pos - start + writer->ext_len - ext_start;
+    *((uint32_t*)&(writer->data[start - 4])) = osc_hton32(elem_len);
+}
+
 int osc_msg_writer_end_msg(osc_writer_t *writer) {
     if (!(writer->state & OSC_WRITER_MSG)) return OSC_ERROR;
     if (writer->state & OSC_WRITER_BUNDLE) {
-        *((uint32_t*)&(writer->data[writer->msg_start - 4])) = writer->pos - writer->msg_start;
+        patch_size(writer, writer->msg_start, writer->msg_ext_start);
         writer->state &= ~OSC_WRITER_MSG;
     } else {
         writer->state = OSC_WRITER_COMPLETE;
@@ -82,16 +171,33 @@ int osc_msg_writer_end_msg(osc_writer_t *writer) {
 }
 
 int osc_msg_writer_start_bundle(osc_writer_t *writer, osc_timetag_t timetag) {
-    if (writer->state != OSC_WRITER_OUT) return OSC_ERROR;
-    ENSURE_REMAIN(12);
-    WRITE_STRING(k_bundle);
+    if (writer->state == OSC_WRITER_BUNDLE) {
+        if (writer->depth == OSC_WRITER_MAX_DEPTH) return OSC_ERROR;
+        ENSURE_REMAIN(4 + 16);
+        writer->pos += 4;
+    } else if (writer->state == OSC_WRITER_OUT) {
+        ENSURE_REMAIN(16);
+    } else {
+        return OSC_ERROR;
+    }
+    writer->bundle_start[writer->depth] = writer->pos;
+    writer->bundle_ext_start[writer->depth] = writer->ext_len;
+    writer->depth++;
+    const char *tag = k_bundle; /* WRITE_STRING advances its argument */
+    WRITE_STRING(tag);
     WRITE_FIXED(osc_timetag_t, 64, timetag);
     writer->state = OSC_WRITER_BUNDLE;
     return OSC_OK;
 }
 
 int osc_msg_writer_end_bundle(osc_writer_t *writer) {
-    writer->state = OSC_WRITER_COMPLETE;
+    if (writer->state != OSC_WRITER_BUNDLE) return OSC_ERROR;
+    writer->depth--;
+    if (writer->depth > 0) {
+        patch_size(writer, writer->bundle_start[writer->depth], writer->bundle_ext_start[writer->depth]);
+    } else {
+        writer->state = OSC_WRITER_COMPLETE;
+    }
     return OSC_OK;
 }
 
@@ -152,7 +258,7 @@ int osc_msg_write_double(osc_writer_t *writer, double val) {
 
 int osc_msg_write_str(osc_writer_t *writer, const char *val) {
     ADD_TYPE('s');
-    ENSURE_REMAIN(ROUND32(strlen(val)));
+    ENSURE_REMAIN(ROUND32(strlen(val) + 1));
     WRITE_STRING(val);
     return OSC_OK;
 }
@@ -161,11 +267,114 @@ int osc_msg_write_blob(osc_writer_t *writer, unsigned char *val, int32_t sz) {
     ADD_TYPE('b');
     ENSURE_REMAIN(4 + ROUND32(sz));
     WRITE_FIXED(int32_t, 32, sz);
-    while (sz--) writer->data[writer->pos++] = *(val++);
-    PAD();
+    if (SIZING()) {
+        writer->pos += ROUND32(sz);
+    } else {
+        while (sz--) writer->data[writer->pos++] = *(val++);
+        PAD();
+    }
+    return OSC_OK;
+}
+
+static int write_run(osc_writer_t *writer, char type, int width, const void *vals, int count) {
+    if (count < 0) return OSC_ERROR;
+    ENSURE_REMAIN(count * width);
+    if (!SIZING()) {
+        memset(writer->data + writer->type_pos, type, count);
+        if (width == 4) {
+            osc_swap32(writer->data + writer->pos, vals, count);
+        } else {
+            osc_swap64(writer->data + writer->pos, vals, count);
+        }
+    }
+    writer->type_pos += count;
+    writer->pos += count * width;
+    return OSC_OK;
+}
+
+int osc_msg_write_int32_array(osc_writer_t *writer, const int32_t *vals, int count) {
+    return write_run(writer, 'i', 4, vals, count);
+}
+
+int osc_msg_write_int64_array(osc_writer_t *writer, const int64_t *vals, int count) {
+    return write_run(writer, 'h', 8, vals, count);
+}
+
+int osc_msg_write_float_array(osc_writer_t *writer, const float *vals, int count) {
+    return write_run(writer, 'f', 4, vals, count);
+}
+
+int osc_msg_write_double_array(osc_writer_t *writer, const double *vals, int count) {
+    return write_run(writer, 'd', 8, vals, count);
+}
+
+/* close the pending buffer segment; its address is resolved by finish_iov() */
+static void push_segment(osc_writer_t *writer) {
+    if (writer->pos > writer->iov_mark) {
+        writer->iov[writer->iov_count].iov_base = NULL;
+        writer->iov[writer->iov_count].iov_len = writer->pos - writer->iov_mark;
+        writer->iov_count++;
+        writer->iov_mark = writer->pos;
+    }
+}
+
+static void push_ref(osc_writer_t *writer, const void *data, int len) {
+    if (len > 0) {
+        writer->iov[writer->iov_count].iov_base = (void*)data;
+        writer->iov[writer->iov_count].iov_len = len;
+        writer->iov_count++;
+        writer->ext_len += len;
+    }
+}
+
+int osc_msg_writer_init_iov(osc_writer_t *writer, void *buffer, int len, osc_iovec_t *iov, int iov_max) {
+    if (osc_msg_writer_init(writer, buffer, len) != OSC_OK) return OSC_ERROR;
+    writer->iov = iov;
+    writer->iov_max = iov_max;
+    return OSC_OK;
+}
+
+int osc_msg_write_blob_ref(osc_writer_t *writer, const void *val, int32_t sz) {
+    if (!writer->iov) return osc_msg_write_blob(writer, (unsigned char*)val, sz);
+    /* preceding buffer segment, payload, padding */
+    if (writer->iov_max - writer->iov_count < 3) return OSC_ERROR;
+    ADD_TYPE('b');
+    ENSURE_REMAIN(4);
+    WRITE_FIXED(int32_t, 32, sz);
+    push_segment(writer);
+    push_ref(writer, val, sz);
+    push_ref(writer, k_zero_pad, ROUND32(sz) - sz);
     return OSC_OK;
 }
 
+int osc_msg_write_str_ref(osc_writer_t *writer, const char *val) {
+    if (!writer->iov) return osc_msg_write_str(writer, val);
+    if (writer->iov_max - writer->iov_count < 3) return OSC_ERROR;
+    ADD_TYPE('s');
+    int len = strlen(val) + 1;
+    push_segment(writer);
+    push_ref(writer, val, len);
+    push_ref(writer, k_zero_pad, ROUND32(len) - len);
+    return OSC_OK;
+}
+
+int osc_msg_writer_finish_iov(osc_writer_t *writer) {
+    if (!writer->iov) return OSC_ERROR;
+    if (writer->pos > writer->iov_mark) {
+        if (writer->iov_count == writer->iov_max) return OSC_ERROR;
+        push_segment(writer);
+    }
+    char *base = writer->data;
+    int i;
+    for (i = 0; i < writer->iov_count; i++) {
+        if (writer->iov[i].iov_base == NULL) {
+            writer->iov[i].iov_base = base;
+            base += writer->iov[i].iov_len;
+        }
+    }
+    return writer->iov_count;
+}
+
 #ifndef OSC_HAVE_VARARG
 
 int osc_writev(osc_writer_t *writer, const char *address, const char *typestring, va_list args) {
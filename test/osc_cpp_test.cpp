@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "little-oscar/osc.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    if (ok) {
+        printf("[ OK ] %s\n", what);
+    } else {
+        printf("[FAIL] %s\n", what);
+        failures++;
+    }
+}
+
+static void test_write_matches_c_writer() {
+    char expected[64], out[64];
+    osc_writer_t writer;
+
+    osc_msg_writer_init(&writer, expected, sizeof(expected));
+    osc_msg_writer_start_msg(&writer, "/meter", 4);
+    osc_msg_write_int32(&writer, 3);
+    osc_msg_write_float(&writer, 0.5f);
+    osc_msg_write_str(&writer, "left");
+    osc_msg_write_double(&writer, -2.0);
+    osc_msg_writer_end_msg(&writer);
+    int len = writer.pos;
+
+    osc_msg_writer_init(&writer, out, sizeof(out));
+    check(osc::write(writer, "/meter", int32_t(3), 0.5f, "left", -2.0) == OSC_OK
+          && writer.pos == len && memcmp(out, expected, len) == 0, "osc::write matches the C writer");
+    check(osc::msg_size("/meter", int32_t(3), 0.5f, "left", -2.0) == len, "osc::msg_size is exact");
+
+    osc_msg_writer_init(&writer, out, len - 4);
+    check(osc::write(writer, "/meter", int32_t(3), 0.5f, "left", -2.0) == OSC_ERROR, "osc::write checks the buffer size");
+}
+
+static void test_write_growable() {
+    osc_writer_t writer;
+
+    osc_msg_writer_init_growable(&writer, nullptr, 0, osc_writer_grow_realloc, nullptr);
+    check(osc::write(writer, "/meter", 3, 0.5f) == OSC_OK && writer.pos == 20
+          && osc_packet_validate(writer.data, writer.pos) == OSC_OK,
+          "osc::write grows a writer that starts without a buffer");
+    free(writer.data);
+
+    osc_msg_writer_init(&writer, nullptr, 0);
+    check(osc::write(writer, "/meter", 3, 0.5f) == OSC_ERROR, "osc::write refuses a sizing writer");
+}
+
+struct meter { int32_t channel; float level; };
+
+static void test_decode() {
+    char buffer[128];
+    osc_writer_t writer;
+    const unsigned char bytes[3] = { 7, 8, 9 };
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    osc::write(writer, "/meter", int32_t(3), 0.5f);
+    int len = writer.pos;
+
+    auto fixed = osc::decode<int32_t, float>(buffer, len);
+    check(fixed && std::get<0>(*fixed) == 3 && std::get<1>(*fixed) == 0.5f, "fixed-width signature decodes");
+    check(!osc::decode<int32_t, double>(buffer, len), "a different signature does not decode");
+    check(!osc::decode<int32_t, float>(buffer, len - 4), "a truncated message does not decode");
+
+    auto m = osc::decode_as<meter, int32_t, float>(buffer, len);
+    check(m && m->channel == 3 && m->level == 0.5f, "decode_as fills an aggregate");
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    osc::write(writer, "/mixed", std::string_view("name"), osc::blob{ bytes, 3 }, osc::nil{}, int64_t(-1));
+    auto mixed = osc::decode<std::string_view, osc::blob, osc::nil, int64_t>(buffer, writer.pos);
+    check(mixed && std::get<0>(*mixed) == "name" && std::get<1>(*mixed).size == 3
+          && memcmp(std::get<1>(*mixed).data, bytes, 3) == 0 && std::get<3>(*mixed) == -1,
+          "variable-width signature decodes");
+}
+
+static void test_write_in_bundle() {
+    char buffer[128];
+    osc_writer_t writer;
+    int ok = 1;
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    ok &= osc_msg_writer_start_bundle(&writer, OSC_NOW) == OSC_OK;
+    ok &= osc::write(writer, "/a", 1) == OSC_OK;
+    ok &= osc_msg_writer_start_bundle(&writer, 2) == OSC_OK;
+    ok &= osc::write(writer, "/b", 2.0) == OSC_OK;
+    ok &= osc_msg_writer_end_bundle(&writer) == OSC_OK;
+    ok &= osc_msg_writer_end_bundle(&writer) == OSC_OK;
+    check(ok && osc_packet_validate(buffer, writer.pos) == OSC_OK, "osc::write adds elements to nested bundles");
+}
+
+int main(int argc, char *argv[]) {
+
+    test_write_matches_c_writer();
+    test_write_growable();
+    test_decode();
+    test_write_in_bundle();
+
+    return failures ? 1 : 0;
+
+}
@@ -0,0 +1,599 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "little-oscar/osc.h"
+#include "little-oscar/osc_internal.h"
+
+static int failures = 0;
+
+static void check(int ok, const char *what) {
+    if (ok) {
+        printf("[ OK ] %s\n", what);
+    } else {
+        printf("[FAIL] %s\n", what);
+        failures++;
+    }
+}
+
+//
+// Stream framing
+
+static void test_slip_resync(void) {
+    char ring[32], scratch[32];
+    char junk[40];
+    const char frame[] = { (char)0xC0, '/', 'o', 'k', 0, ',', 0, 0, 0, (char)0xC0 };
+    osc_stream_t stream;
+    const char *packet;
+    int len, fed, res;
+
+    memset(junk, 'x', sizeof(junk));
+    osc_stream_init(&stream, OSC_STREAM_SLIP, ring, sizeof(ring), scratch, sizeof(scratch));
+
+    fed = osc_stream_feed(&stream, junk, sizeof(junk));
+    check(fed == sizeof(ring), "SLIP: ring accepts as much of an oversized frame as fits");
+    check(osc_stream_next(&stream, &packet, &len) == OSC_ERROR, "SLIP: oversized frame is reported");
+
+    fed += osc_stream_feed(&stream, junk + fed, sizeof(junk) - fed);
+    check(fed == sizeof(junk), "SLIP: ring accepts the rest of the oversized frame");
+    check(osc_stream_next(&stream, &packet, &len) == OSC_END, "SLIP: oversized frame is reported once");
+
+    osc_stream_feed(&stream, frame, sizeof(frame));
+    res = osc_stream_next(&stream, &packet, &len);
+    check(res == OSC_OK && len == 8 && memcmp(packet, "/ok\0,\0\0\0", 8) == 0,
+          "SLIP: stream resyncs at the END after an oversized frame");
+    check(osc_stream_next(&stream, &packet, &len) == OSC_END, "SLIP: no further packets");
+}
+
+//
+// Writers
+
+/* write a message with one of each variable and fixed-width argument */
+static int write_sample_msg(osc_writer_t *writer) {
+    unsigned char blob[5] = { 1, 2, 3, 4, 5 };
+    if (osc_msg_writer_start_msg(writer, "/sample/msg", 4) != OSC_OK) return OSC_ERROR;
+    if (osc_msg_write_int32(writer, 42) != OSC_OK) return OSC_ERROR;
+    if (osc_msg_write_str(writer, "hello") != OSC_OK) return OSC_ERROR;
+    if (osc_msg_write_double(writer, 0.5) != OSC_OK) return OSC_ERROR;
+    if (osc_msg_write_blob(writer, blob, sizeof(blob)) != OSC_OK) return OSC_ERROR;
+    return osc_msg_writer_end_msg(writer);
+}
+
+static void test_growable_writers(void) {
+    osc_writer_t sizer, writer;
+    char fixed[64];
+    char *msg;
+    int size;
+
+    osc_msg_writer_init(&sizer, NULL, 0);
+    check(write_sample_msg(&sizer) == OSC_OK, "sizing writer accepts a message");
+    size = sizer.pos;
+    check(size == osc_msg_size("/sample/msg", ",isdb", osc_str_size("hello") + osc_blob_size(5)),
+          "sizing writer agrees with osc_msg_size()");
+    check(osc_msg_writer_reserve_msg(&sizer, 8) == NULL, "sizing writer cannot reserve a message");
+
+    osc_msg_writer_init(&writer, fixed, sizeof(fixed));
+    check(write_sample_msg(&writer) == OSC_OK && writer.pos == size, "fixed writer writes the sized number of bytes");
+
+    osc_msg_writer_init_growable(&writer, NULL, 0, osc_writer_grow_realloc, NULL);
+    check(write_sample_msg(&writer) == OSC_OK && writer.pos == size && memcmp(writer.data, fixed, size) == 0,
+          "growable writer with a NULL buffer grows and writes the same bytes");
+    free(writer.data);
+
+    osc_msg_writer_init_growable(&writer, NULL, 0, osc_writer_grow_realloc, NULL);
+    msg = osc_msg_writer_reserve_msg(&writer, 8);
+    check(msg != NULL, "growable writer with a NULL buffer can reserve a message");
+    if (msg) {
+        memcpy(msg, "/ok\0,\0\0\0", 8);
+        check(osc_msg_writer_end_msg(&writer) == OSC_OK && osc_packet_validate(writer.data, writer.pos) == OSC_OK,
+              "reserved message is complete");
+    }
+    free(writer.data);
+}
+
+//
+// Nested bundles
+
+static int count_msg(osc_msg_reader_t *reader, osc_timetag_t timetag, void *userdata) {
+    int *count = (int *)userdata;
+    (*count)++;
+    return OSC_OK;
+}
+
+static void test_nested_bundles(void) {
+    char buffer[256];
+    osc_writer_t writer, sizer;
+    int i, count, ok = 1;
+
+    /* a message, a bundle holding a nested empty bundle and a message, and a
+     * trailing empty bundle */
+    for (i = 0; i < 2; i++) {
+        osc_writer_t *w = i ? &writer : &sizer;
+        if (i) osc_msg_writer_init(w, buffer, sizeof(buffer)); else osc_msg_writer_init(w, NULL, 0);
+        ok &= osc_msg_writer_start_bundle(w, OSC_NOW) == OSC_OK;
+        ok &= write_sample_msg(w) == OSC_OK;
+        ok &= osc_msg_writer_start_bundle(w, 1) == OSC_OK;
+        ok &= osc_msg_writer_start_bundle(w, 2) == OSC_OK;
+        ok &= osc_msg_writer_end_bundle(w) == OSC_OK;
+        ok &= write_sample_msg(w) == OSC_OK;
+        ok &= osc_msg_writer_end_bundle(w) == OSC_OK;
+        ok &= osc_msg_writer_start_bundle(w, 3) == OSC_OK;
+        ok &= osc_msg_writer_end_bundle(w) == OSC_OK;
+        ok &= osc_msg_writer_end_bundle(w) == OSC_OK;
+    }
+    check(ok, "nested bundles are written");
+    check(writer.pos == sizer.pos, "sizing writer agrees on nested bundle size");
+    check(osc_packet_validate(buffer, writer.pos) == OSC_OK, "nested bundles with empty bundles validate");
+
+    count = 0;
+    check(osc_packet_walk(buffer, writer.pos, count_msg, &count) == OSC_OK && count == 2,
+          "walk visits every message of nested bundles with empty bundles");
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    osc_msg_writer_start_bundle(&writer, OSC_NOW);
+    osc_msg_writer_end_bundle(&writer);
+    count = 0;
+    check(writer.pos == 16 && osc_packet_validate(buffer, 16) == OSC_OK
+          && osc_packet_walk(buffer, 16, count_msg, &count) == OSC_OK && count == 0,
+          "an empty bundle validates and walks");
+
+    check(osc_packet_validate(buffer, 12) == OSC_ERROR && osc_packet_walk(buffer, 12, count_msg, &count) == OSC_ERROR,
+          "a bundle shorter than its header is rejected");
+}
+
+//
+// Reading
+
+static void test_arg_index(void) {
+    char buffer[64];
+    osc_writer_t writer;
+    osc_msg_reader_t reader;
+    int32_t offsets[8], i32;
+    const char *str;
+    double d;
+    void *blob;
+    int32_t blob_len;
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    write_sample_msg(&writer);
+
+    osc_msg_reader_init(&reader, buffer, writer.pos);
+    check(osc_msg_reader_index_args(&reader, offsets, 8) == 4, "index covers every argument");
+    check(osc_msg_reader_seek_arg(&reader, offsets, 2) == 'd' && osc_msg_reader_get_arg_double(&reader, &d) == OSC_OK
+          && d == 0.5, "seek reads an argument out of order");
+    check(osc_msg_reader_seek_arg(&reader, offsets, 0) == 'i' && osc_msg_reader_get_arg_int32(&reader, &i32) == OSC_OK
+          && i32 == 42, "seek moves backwards");
+    check(osc_msg_reader_next_arg(&reader) == 's' && osc_msg_reader_get_arg_str(&reader, &str) == OSC_OK
+          && strcmp(str, "hello") == 0, "next_arg continues after a seek");
+    check(osc_msg_reader_seek_arg(&reader, offsets, 3) == 'b' && osc_msg_reader_get_arg_blob(&reader, &blob, &blob_len) == OSC_OK
+          && blob_len == 5 && ((unsigned char *)blob)[4] == 5, "seek reads the last argument");
+    check(osc_msg_reader_index_args(&reader, offsets, 2) == 2, "index stops at max_args");
+
+    /* cut the blob's data off */
+    osc_msg_reader_init(&reader, buffer, writer.pos - 8);
+    check(osc_msg_reader_index_args(&reader, offsets, 8) == OSC_ERROR, "index rejects a truncated message");
+}
+
+static void test_unterminated_strings(void) {
+    /* sized to leave out the literals' NULs, so each message ends mid-string */
+    const char address[32] = "/abcdefghijklmnopqrstuvwxyz01234";
+    const char typetag[32] = "/a\0\0,sssssssssssssssssssssssssss";
+    const char argument[40] = "/a\0\0,s\0\0abcdefghijklmnopqrstuvwxyz012345";
+    osc_msg_reader_t reader;
+    const char *str;
+
+    check(osc_msg_reader_init(&reader, address, 32) == OSC_ERROR, "unterminated address is rejected");
+    check(osc_msg_reader_init(&reader, typetag, 32) == OSC_ERROR, "unterminated type tag is rejected");
+    check(osc_msg_reader_init(&reader, argument, 40) == OSC_OK && osc_msg_reader_next_arg(&reader) == 's'
+          && osc_msg_reader_get_arg_str(&reader, &str) == OSC_ERROR, "unterminated string argument is rejected");
+    check(osc_msg_reader_init(&reader, argument, 40) == OSC_OK && osc_packet_validate(argument, 40) == OSC_ERROR,
+          "validate rejects an unterminated string argument");
+}
+
+static void test_arrays(void) {
+    char buffer[512];
+    osc_writer_t writer;
+    osc_msg_reader_t reader;
+    int32_t ints[13], ints_out[16];
+    double doubles[5], doubles_out[5];
+    float fl;
+    int i, ok = 1;
+
+    /* odd counts, so the vector paths' tails are exercised too */
+    for (i = 0; i < 13; i++) ints[i] = (i - 6) * 0x01020304;
+    for (i = 0; i < 5; i++) doubles[i] = i * -1.25;
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    ok &= osc_msg_writer_start_msg(&writer, "/arrays", 19) == OSC_OK;
+    ok &= osc_msg_write_int32_array(&writer, ints, 13) == OSC_OK;
+    ok &= osc_msg_write_float(&writer, 2.5f) == OSC_OK;
+    ok &= osc_msg_write_double_array(&writer, doubles, 5) == OSC_OK;
+    ok &= osc_msg_writer_end_msg(&writer) == OSC_OK;
+    check(ok && osc_packet_validate(buffer, writer.pos) == OSC_OK, "array message is written");
+
+    osc_msg_reader_init(&reader, buffer, writer.pos);
+    check(osc_msg_reader_get_int32_array(&reader, ints_out, 16) == 13 && memcmp(ints, ints_out, sizeof(ints)) == 0,
+          "int32 array reads back, stopping at the next type");
+    check(osc_msg_reader_get_double_array(&reader, doubles_out, 5) == 0, "array reader rejects a different type");
+    check(osc_msg_reader_next_arg(&reader) == 'f' && osc_msg_reader_get_arg_float(&reader, &fl) == OSC_OK && fl == 2.5f,
+          "scalar reads continue after an array");
+    check(osc_msg_reader_get_double_array(&reader, doubles_out, 3) == 3
+          && osc_msg_reader_get_double_array(&reader, doubles_out + 3, 3) == 2
+          && memcmp(doubles, doubles_out, sizeof(doubles)) == 0, "double array reads back in pieces");
+
+    osc_msg_reader_init(&reader, buffer, writer.pos - 8);
+    osc_msg_reader_get_int32_array(&reader, ints_out, 16);
+    osc_msg_reader_next_arg(&reader);
+    osc_msg_reader_get_arg_float(&reader, &fl);
+    check(osc_msg_reader_get_double_array(&reader, doubles_out, 5) == OSC_ERROR, "array reader rejects a truncated run");
+}
+
+static void test_misaligned_swaps(void) {
+    static uint64_t storage[32];
+    char *bytes = (char *)storage;
+    char *src = bytes + 1, *dst = bytes + 128 + 3;
+    osc_writer_t writer;
+    osc_msg_reader_t reader;
+    int64_t longs[7], longs_out[7];
+    int i, ok = 1;
+
+    /* odd counts, so the scalar tails run on every build */
+    for (i = 0; i < 4 * 7; i++) src[i] = (char)i;
+    osc_swap32(dst, src, 7);
+    for (i = 0; i < 4 * 7; i++) ok &= dst[i] == src[(i & ~3) + 3 - (i & 3)];
+    check(ok, "osc_swap32 converts between misaligned buffers");
+
+    ok = 1;
+    for (i = 0; i < 8 * 7; i++) src[i] = (char)i;
+    osc_swap64(dst, src, 7);
+    for (i = 0; i < 8 * 7; i++) ok &= dst[i] == src[(i & ~7) + 7 - (i & 7)];
+    check(ok, "osc_swap64 converts between misaligned buffers");
+
+    /* a 4-byte address and a 12-byte type tag leave the run only 4-byte aligned */
+    for (i = 0; i < 7; i++) longs[i] = (int64_t)0x0102030405060708ll * (i - 3);
+    osc_msg_writer_init(&writer, (char *)storage + 4, 200);
+    osc_msg_writer_start_msg(&writer, "/l", 7);
+    osc_msg_write_int64_array(&writer, longs, 7);
+    osc_msg_writer_end_msg(&writer);
+    osc_msg_reader_init(&reader, (char *)storage + 4, writer.pos);
+    check(osc_msg_reader_get_int64_array(&reader, longs_out, 7) == 7 && memcmp(longs, longs_out, sizeof(longs)) == 0,
+          "int64 array reads from message data that is only 4-byte aligned");
+}
+
+typedef struct {
+    int32_t     i;
+    const char  *s;
+    double      d;
+} sample_t;
+
+static void test_decoder(void) {
+    char buffer[64];
+    osc_writer_t writer;
+    osc_msg_reader_t reader;
+    osc_msg_decoder_t decoder;
+    const int32_t offsets[] = { offsetof(sample_t, i), offsetof(sample_t, s), offsetof(sample_t, d) };
+    sample_t sample;
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    osc_msg_writer_start_msg(&writer, "/sample", 3);
+    osc_msg_write_int32(&writer, -7);
+    osc_msg_write_str(&writer, "abc");
+    osc_msg_write_double(&writer, 1e100);
+    osc_msg_writer_end_msg(&writer);
+
+    check(osc_msg_decoder_init(&decoder, ",isd", offsets) == OSC_OK, "decoder compiles");
+    osc_msg_reader_init(&reader, buffer, writer.pos);
+    check(osc_msg_reader_decode(&reader, &decoder, &sample) == OSC_OK
+          && sample.i == -7 && strcmp(sample.s, "abc") == 0 && sample.d == 1e100, "decoder fills the struct");
+
+    check(osc_msg_decoder_init(&decoder, "isf", offsets) == OSC_OK, "decoder compiles without a leading ','");
+    osc_msg_reader_init(&reader, buffer, writer.pos);
+    check(osc_msg_reader_decode(&reader, &decoder, &sample) == OSC_ERROR, "decoder rejects a different type tag");
+
+    check(osc_msg_decoder_init(&decoder, ",isd", offsets) == OSC_OK, "decoder recompiles");
+    osc_msg_reader_init(&reader, buffer, writer.pos - 4);
+    check(osc_msg_reader_decode(&reader, &decoder, &sample) == OSC_ERROR, "decoder rejects a truncated message");
+}
+
+static void test_unchecked_reader(void) {
+    char buffer[64];
+    osc_writer_t writer;
+    osc_msg_reader_t checked, unchecked;
+    osc_arg_t a, b;
+    int n = 0, same = 1;
+
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    write_sample_msg(&writer);
+    check(osc_packet_validate(buffer, writer.pos) == OSC_OK, "sample message validates");
+    check(osc_packet_validate(buffer, writer.pos - 4) == OSC_ERROR, "truncated message does not validate");
+
+    osc_msg_reader_init(&checked, buffer, writer.pos);
+    osc_msg_reader_init_unchecked(&unchecked, buffer, writer.pos);
+    while (osc_msg_reader_get_arg(&checked, &a) == OSC_OK) {
+        if (osc_msg_reader_get_arg_unchecked(&unchecked, &b) != OSC_OK || a.type != b.type) same = 0;
+        else if (a.type == 'i' && a.val.val_int32 != b.val.val_int32) same = 0;
+        else if (a.type == 's' && strcmp(a.val.val_str, b.val.val_str) != 0) same = 0;
+        else if (a.type == 'd' && a.val.val_double != b.val.val_double) same = 0;
+        n++;
+    }
+    check(same && n == 4 && osc_msg_reader_get_arg_unchecked(&unchecked, &b) == OSC_END,
+          "unchecked reader agrees with the checked reader");
+}
+
+static void test_size_prefix_stream(void) {
+    char ring[32], scratch[32], wire[64];
+    osc_stream_t stream;
+    const char *packet;
+    int len, i, ok = 1;
+
+    /* a 20-byte message then an 8-byte one, each preceded by its length */
+    memcpy(wire, "\0\0\0\x14/first/packet\0\0\0\0,\0\0\0", 24);
+    memcpy(wire + 24, "\0\0\0\x08/two\0,\0\0\0", 12);
+
+    osc_stream_init(&stream, OSC_STREAM_SIZE_PREFIX, ring, sizeof(ring), scratch, sizeof(scratch));
+    for (i = 0; i < 24; i++) {
+        ok &= osc_stream_next(&stream, &packet, &len) == OSC_END;
+        osc_stream_feed(&stream, wire + i, 1);
+    }
+    check(ok, "size-prefixed: partial packets wait for more data");
+    check(osc_stream_next(&stream, &packet, &len) == OSC_OK && len == 20 && memcmp(packet, "/first/packet", 14) == 0,
+          "size-prefixed: packet fed a byte at a time is extracted");
+    osc_stream_feed(&stream, wire + 24, 3);
+    check(osc_stream_next(&stream, &packet, &len) == OSC_END, "size-prefixed: split length prefix waits for more data");
+
+    /* the second packet now wraps around the end of the ring */
+    osc_stream_feed(&stream, wire + 27, 9);
+    check(osc_stream_next(&stream, &packet, &len) == OSC_OK && len == 8 && packet == scratch
+          && memcmp(packet, "/two\0,\0\0\0", 8) == 0, "size-prefixed: wrapped packet is reassembled in scratch");
+    check(osc_stream_next(&stream, &packet, &len) == OSC_END, "size-prefixed: no further packets");
+
+    osc_stream_feed(&stream, "\0\0\0\x40", 4);
+    check(osc_stream_next(&stream, &packet, &len) == OSC_ERROR, "size-prefixed: packet larger than the ring is an error");
+}
+
+static void test_templates(void) {
+    char image[64], expected[64], out[128];
+    osc_msg_template_t tpl;
+    osc_writer_t writer;
+    int ok = 1;
+
+    check(osc_msg_template_init(&tpl, image, sizeof(image), "/meter", ",ifTd") == OSC_OK, "template compiles");
+    osc_msg_template_set_int32(&tpl, 0, 3);
+    osc_msg_template_set_float(&tpl, 1, -0.25f);
+    osc_msg_template_set_double(&tpl, 3, 8.5);
+
+    osc_msg_writer_init(&writer, expected, sizeof(expected));
+    ok &= osc_msg_writer_start_msg(&writer, "/meter", 4) == OSC_OK;
+    ok &= osc_msg_write_int32(&writer, 3) == OSC_OK;
+    ok &= osc_msg_write_float(&writer, -0.25f) == OSC_OK;
+    ok &= osc_msg_write_true(&writer) == OSC_OK;
+    ok &= osc_msg_write_double(&writer, 8.5) == OSC_OK;
+    ok &= osc_msg_writer_end_msg(&writer) == OSC_OK;
+
+    check(ok && osc_msg_template_copy(&tpl, out, sizeof(out)) == writer.pos && memcmp(out, expected, writer.pos) == 0,
+          "template image matches the same message written normally");
+    check(osc_msg_template_copy(&tpl, out, writer.pos - 4) == OSC_ERROR, "template copy checks the buffer size");
+
+    osc_msg_writer_init(&writer, out, sizeof(out));
+    osc_msg_writer_start_bundle(&writer, OSC_NOW);
+    ok = osc_msg_writer_write_template(&writer, &tpl) == OSC_OK;
+    ok &= osc_msg_writer_write_template(&writer, &tpl) == OSC_OK;
+    osc_msg_writer_end_bundle(&writer);
+    check(ok && writer.pos == 16 + 2 * (4 + tpl.len) && osc_packet_validate(out, writer.pos) == OSC_OK,
+          "templates are written into a bundle");
+
+    osc_msg_writer_init(&writer, NULL, 0);
+    check(osc_msg_writer_write_template(&writer, &tpl) == OSC_OK && writer.pos == tpl.len,
+          "sizing writer counts a template without storing it");
+    osc_msg_writer_init_growable(&writer, NULL, 0, osc_writer_grow_realloc, NULL);
+    check(osc_msg_writer_write_template(&writer, &tpl) == OSC_OK && writer.pos == tpl.len
+          && memcmp(writer.data, image, tpl.len) == 0, "growable writer with a NULL buffer stores a template");
+    free(writer.data);
+
+    check(osc_msg_template_init(&tpl, image, sizeof(image), "/meter", ",s") == OSC_ERROR,
+          "template rejects variable-width types");
+    check(osc_msg_template_init(&tpl, image, 12, "/meter", ",i") == OSC_ERROR, "template rejects a small buffer");
+}
+
+static void test_scatter_gather(void) {
+    static unsigned char payload[1001];
+    char header[128], flat[1200], expected[1200];
+    osc_iovec_t iov[8];
+    osc_writer_t writer;
+    int i, n, len = 0, ok = 1;
+
+    for (i = 0; i < (int)sizeof(payload); i++) payload[i] = (unsigned char)i;
+
+    osc_msg_writer_init(&writer, expected, sizeof(expected));
+    osc_msg_writer_start_bundle(&writer, OSC_NOW);
+    osc_msg_writer_start_msg(&writer, "/blob", 3);
+    osc_msg_write_blob(&writer, payload, sizeof(payload));
+    osc_msg_write_str(&writer, "referenced");
+    osc_msg_write_int32(&writer, 9);
+    osc_msg_writer_end_msg(&writer);
+    osc_msg_writer_end_bundle(&writer);
+
+    osc_msg_writer_init_iov(&writer, header, sizeof(header), iov, 8);
+    ok &= osc_msg_writer_start_bundle(&writer, OSC_NOW) == OSC_OK;
+    ok &= osc_msg_writer_start_msg(&writer, "/blob", 3) == OSC_OK;
+    ok &= osc_msg_write_blob_ref(&writer, payload, sizeof(payload)) == OSC_OK;
+    ok &= osc_msg_write_str_ref(&writer, "referenced") == OSC_OK;
+    ok &= osc_msg_write_int32(&writer, 9) == OSC_OK;
+    ok &= osc_msg_writer_end_msg(&writer) == OSC_OK;
+    ok &= osc_msg_writer_end_bundle(&writer) == OSC_OK;
+    n = osc_msg_writer_finish_iov(&writer);
+    check(ok && n > 1, "scatter-gather writer references its payloads");
+
+    for (i = 0; i < n && len + (int)iov[i].iov_len <= (int)sizeof(flat); i++) {
+        memcpy(flat + len, iov[i].iov_base, iov[i].iov_len);
+        len += iov[i].iov_len;
+    }
+    check(len == writer.pos + writer.ext_len && memcmp(flat, expected, len) == 0,
+          "scatter-gather output matches the copied encoding");
+    check(writer.pos < 128, "referenced payloads are not copied into the buffer");
+
+    /* a header segment, the payload and its padding fill all four */
+    osc_msg_writer_init_iov(&writer, header, sizeof(header), iov, 4);
+    osc_msg_writer_start_msg(&writer, "/blob", 2);
+    check(osc_msg_write_blob_ref(&writer, payload, sizeof(payload)) == OSC_OK
+          && osc_msg_write_blob_ref(&writer, payload, sizeof(payload)) == OSC_ERROR,
+          "referencing a payload fails once the iovec array is full");
+}
+
+static void test_arena(void) {
+    static uint64_t storage[32];
+    char *block = (char *)storage;
+    osc_arena_t arena;
+    osc_writer_t writer;
+    char *first, *second;
+    void *small;
+
+    osc_arena_init(&arena, block, sizeof(storage));
+    small = osc_arena_alloc(&arena, 3);
+    check(small != NULL && ((uintptr_t)osc_arena_alloc(&arena, 8) & 7) == 0, "arena allocations are 8-byte aligned");
+
+    osc_msg_writer_init_arena(&writer, &arena);
+    write_sample_msg(&writer);
+    first = osc_arena_commit(&arena, &writer);
+    osc_msg_writer_init_arena(&writer, &arena);
+    write_sample_msg(&writer);
+    second = osc_arena_commit(&arena, &writer);
+    check(first && second && second >= first + writer.pos && memcmp(first, second, writer.pos) == 0
+          && osc_packet_validate(first, writer.pos) == OSC_OK, "committed messages stay intact in the arena");
+
+    osc_msg_writer_init_arena(&writer, &arena);
+    check(osc_msg_writer_start_msg(&writer, "/big", 1) == OSC_OK
+          && osc_msg_write_blob(&writer, (unsigned char *)block, 200) == OSC_ERROR, "writer stops at the end of the arena");
+    check(osc_arena_alloc(&arena, 256) == NULL, "arena refuses an allocation that does not fit");
+
+    osc_arena_reset(&arena);
+    check(osc_arena_alloc(&arena, 256) == block, "reset releases everything at once");
+}
+
+typedef struct {
+    int     packets;
+    int     len[8];
+    int     msgs[8];
+} flushed_t;
+
+static void record_flush(const char *packet, int len, void *userdata) {
+    flushed_t *flushed = (flushed_t *)userdata;
+    int count = 0;
+    if (osc_packet_validate(packet, len) != OSC_OK) count = -1;
+    else osc_packet_walk(packet, len, count_msg, &count);
+    if (flushed->packets < 8) {
+        flushed->len[flushed->packets] = len;
+        flushed->msgs[flushed->packets] = count;
+    }
+    flushed->packets++;
+}
+
+static void test_packer(void) {
+    char buffer[256];
+    const char msg[8] = "/ok\0,\0\0\0";
+    osc_packer_t packer;
+    osc_writer_t *writer;
+    flushed_t flushed;
+    int i, ok = 1;
+
+    memset(&flushed, 0, sizeof(flushed));
+    osc_packer_init(&packer, buffer, sizeof(buffer), 128, 1000, record_flush, &flushed);
+
+    /* nine 12-byte elements fill a 128-byte bundle; the tenth spills */
+    for (i = 0; i < 10; i++) ok &= osc_packer_add(&packer, 5, msg, 8, 0) == OSC_OK;
+    check(ok && flushed.packets == 1 && flushed.len[0] == 124 && flushed.msgs[0] == 9,
+          "packer flushes a full bundle when the next message would pass the MTU");
+    writer = osc_packer_start_msg(&packer, 6, "/other", 1, 10);
+    check(writer && flushed.packets == 2 && flushed.msgs[1] == 1 && flushed.len[1] == 28,
+          "packer flushes when the timetag changes");
+    osc_msg_write_int32(writer, 1);
+    osc_packer_end_msg(&packer, 10);
+    osc_packer_poll(&packer, 1009);
+    check(flushed.packets == 2, "packer holds a bundle until its deadline");
+    osc_packer_poll(&packer, 1010);
+    check(flushed.packets == 3 && flushed.msgs[2] == 1, "packer flushes a bundle at its deadline");
+
+    writer = osc_packer_start_msg(&packer, OSC_NOW, "/cancelled", 0, 2000);
+    osc_packer_cancel_msg(&packer);
+    osc_packer_add(&packer, OSC_NOW, msg, 8, 2000);
+    osc_packer_flush(&packer);
+    check(flushed.packets == 4 && flushed.len[3] == 8 && flushed.msgs[3] == 1,
+          "a lone immediate message is sent bare, without a cancelled one");
+}
+
+static int record_timetag(osc_msg_reader_t *reader, osc_timetag_t timetag, void *userdata) {
+    osc_timetag_t *timetags = (osc_timetag_t *)userdata;
+    int32_t i;
+    osc_msg_reader_next_arg(reader);
+    if (osc_msg_reader_get_arg_int32(reader, &i) == OSC_OK && i >= 0 && i < 8) timetags[i] = timetag;
+    return OSC_OK;
+}
+
+static void test_bundle_depth(void) {
+    char buffer[512];
+    osc_writer_t writer;
+    osc_timetag_t timetags[8];
+    int i, ok = 1;
+
+    /* one message at each level, tagged with its depth */
+    osc_msg_writer_init(&writer, buffer, sizeof(buffer));
+    for (i = 0; i < OSC_WRITER_MAX_DEPTH; i++) {
+        ok &= osc_msg_writer_start_bundle(&writer, 100 + i) == OSC_OK;
+        ok &= osc_msg_writer_start_msg(&writer, "/depth", 1) == OSC_OK;
+        ok &= osc_msg_write_int32(&writer, i) == OSC_OK;
+        ok &= osc_msg_writer_end_msg(&writer) == OSC_OK;
+    }
+    check(ok, "bundles nest up to OSC_WRITER_MAX_DEPTH");
+    check(osc_msg_writer_start_bundle(&writer, 1) == OSC_ERROR, "bundles do not nest any deeper");
+
+    osc_msg_writer_start_msg(&writer, "/open", 0);
+    check(osc_msg_writer_end_bundle(&writer) == OSC_ERROR, "a bundle cannot end inside a message");
+    osc_msg_writer_end_msg(&writer);
+    for (i = 0; i < OSC_WRITER_MAX_DEPTH; i++) ok &= osc_msg_writer_end_bundle(&writer) == OSC_OK;
+    check(ok && osc_msg_writer_end_bundle(&writer) == OSC_ERROR, "every bundle ends once");
+
+    memset(timetags, 0, sizeof(timetags));
+    ok = osc_packet_validate(buffer, writer.pos) == OSC_OK
+         && osc_packet_walk(buffer, writer.pos, record_timetag, timetags) == OSC_OK;
+    for (i = 0; i < OSC_WRITER_MAX_DEPTH; i++) ok &= timetags[i] == (osc_timetag_t)(100 + i);
+    check(ok, "each message is walked with its innermost bundle's timetag");
+}
+
+static void test_size_helpers(void) {
+    osc_writer_t sizer;
+    int msg_len = osc_msg_size("/sample/msg", "isdb", osc_str_size("hello") + osc_blob_size(5));
+
+    osc_msg_writer_init(&sizer, NULL, 0);
+    osc_msg_writer_start_bundle(&sizer, OSC_NOW);
+    write_sample_msg(&sizer);
+    write_sample_msg(&sizer);
+    osc_msg_writer_end_bundle(&sizer);
+    check(sizer.pos == osc_bundle_size(2, 2 * msg_len), "osc_bundle_size agrees with the sizing writer");
+    check(osc_str_size("") == 4 && osc_str_size("abc") == 4 && osc_str_size("abcd") == 8, "strings are sized with their NUL");
+    check(osc_blob_size(0) == 4 && osc_blob_size(1) == 8 && osc_blob_size(4) == 8, "blobs are sized with their length");
+    check(osc_msg_size("/a", ",iq", 0) == OSC_ERROR, "osc_msg_size rejects unknown types");
+}
+
+int main(int argc, char *argv[]) {
+
+    test_slip_resync();
+    test_growable_writers();
+    test_nested_bundles();
+    test_arg_index();
+    test_unterminated_strings();
+    test_arrays();
+    test_misaligned_swaps();
+    test_decoder();
+    test_unchecked_reader();
+    test_size_prefix_stream();
+    test_templates();
+    test_scatter_gather();
+    test_arena();
+    test_packer();
+    test_bundle_depth();
+    test_size_helpers();
+
+    return failures ? 1 : 0;
+
+}
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "little-oscar/osc_internal.h"
+
+/*
+ * Measures reader cost on messages dominated by string scanning: a long
+ * address with a short payload, and a short address followed by many string
+ * arguments.
+ *
+ * Each message is parsed with the library's bounded scanner and, for
+ * comparison, with a bounded byte-at-a-time loop (the naive way to avoid
+ * relying on a trailing NUL) and with unbounded strlen() (the previous
+ * behaviour, which needs a sentinel byte after the packet). The library's own
+ * reader is timed on the same messages, with and without fetching the address
+ * hash that dispatchers use.
+ */
+
+#define ITERATIONS 2000000
+
+typedef int (*scan_fn)(const char *ptr, const char *end);
+
+static int scan_bytewise(const char *ptr, const char *end) {
+    const char *p = ptr;
+    while (p < end) {
+        if (!*p) return (int)(p - ptr);
+        p++;
+    }
+    return OSC_ERROR;
+}
+
+static int scan_strlen(const char *ptr, const char *end) {
+    return (int)strlen(ptr);
+}
+
+static double now_s(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int put_str(char *buffer, int pos, const char *str) {
+    int len = strlen(str) + 1;
+    memcpy(buffer + pos, str, len);
+    pos += len;
+    while (pos & 3) buffer[pos++] = '\0';
+    return pos;
+}
+
+/* mirrors osc_msg_reader_init() + osc_msg_reader_get_arg_str() */
+static int parse(scan_fn scan, const char *msg, int len) {
+    const char *end = msg + len;
+    int n = scan(msg, end);
+    if (n < 0) return -1;
+    const char *p = msg + ROUND32(n + 1);
+    n = scan(p, end);
+    if (n < 0) return -1;
+    const char *types = p + 1;
+    p += ROUND32(n + 1);
+    int total = 0;
+    while (*types == 's') {
+        n = scan(p, end);
+        if (n < 0) return -1;
+        p += ROUND32(n + 1);
+        total += n;
+        types++;
+    }
+    return total;
+}
+
+/* the same work through the real reader */
+static int parse_reader(const char *msg, int len, int hash) {
+    osc_msg_reader_t reader;
+    const char *str;
+    int total = 0;
+    if (osc_msg_reader_init(&reader, msg, len) != OSC_OK) return -1;
+    if (hash) total += (int)(osc_msg_reader_get_address_hash(&reader) & 1);
+    while (osc_msg_reader_next_arg(&reader) == 's') {
+        if (osc_msg_reader_get_arg_str(&reader, &str) != OSC_OK) return -1;
+        total += (int)strlen(str);
+    }
+    return total;
+}
+
+static void bench(const char *label, const char *msg, int len) {
+    static const struct { const char *name; scan_fn fn; } impls[] = {
+        { "bytewise", scan_bytewise },
+        { "strlen  ", scan_strlen },
+        { "osc_scan", osc_scan_nul }
+    };
+    int i, j;
+    printf("%s (%d bytes)\n", label, len);
+    for (j = 0; j < 3; j++) {
+        volatile int sink = 0;
+        double start = now_s();
+        for (i = 0; i < ITERATIONS; i++) sink += parse(impls[j].fn, msg, len);
+        double elapsed = now_s() - start;
+        printf("  %s  %7.1f ns/msg\n", impls[j].name, elapsed * 1e9 / ITERATIONS);
+    }
+    for (j = 0; j < 2; j++) {
+        volatile int sink = 0;
+        double start = now_s();
+        for (i = 0; i < ITERATIONS; i++) sink += parse_reader(msg, len, j);
+        double elapsed = now_s() - start;
+        printf("  %s  %7.1f ns/msg\n", j ? "reader+h" : "reader  ", elapsed * 1e9 / ITERATIONS);
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    char buffer[2048];
+    int len, i;
+
+    len = put_str(buffer, 0, "/studio/rack/3/unit/12/module/reverb/parameters/early_reflections/diffusion");
+    len = put_str(buffer, len, ",s");
+    len = put_str(buffer, len, "on");
+    bench("long address", buffer, len);
+
+    len = put_str(buffer, 0, "/lyrics");
+    len = put_str(buffer, len, ",ssssssss");
+    for (i = 0; i < 8; i++) {
+        len = put_str(buffer, len, "the quick brown fox jumps over the lazy dog, twice over");
+    }
+    bench("string-heavy", buffer, len);
+
+    return 0;
+
+}
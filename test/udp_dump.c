@@ -5,22 +5,23 @@
 #include <netinet/in.h>
 
 #define BUFFER_SIZE 1536
+#define BATCH_SIZE  32
 
 #include "little-oscar/osc.h"
+#include "little-oscar/osc_udp.h"
 
 void dump_osc_message(osc_msg_reader_t *reader, int indent);
 void dump_osc_packet(const char *buffer, int len, int indent);
 
+static void on_packet(const char *buffer, int len, const struct sockaddr *from, socklen_t from_len, void *userdata) {
+    dump_osc_packet(buffer, len, 0);
+}
+
 int main(int argc, char *argv[]) {
     
-    int sock_fd, n;
-    struct sockaddr_in server_address, client_address;
-    socklen_t len;
-    
-    // last byte set to NUL; ensures unterminated strings in message payload
-    // cannot break out of the buffer.
-    char buffer[BUFFER_SIZE];
-    buffer[BUFFER_SIZE - 1] = '\0';
+    int sock_fd;
+    struct sockaddr_in server_address;
+    osc_udp_receiver_t rx;
     
     sock_fd = socket(AF_INET, SOCK_DGRAM, 0);
     
@@ -29,12 +30,16 @@ int main(int argc, char *argv[]) {
     server_address.sin_port = htons(9000);
     bind(sock_fd, (struct sockaddr *)&server_address, sizeof(server_address));
     
+    if (osc_udp_receiver_init(&rx, sock_fd, BATCH_SIZE, BUFFER_SIZE) != OSC_OK) {
+        return 1;
+    }
+    
     for (;;) {
-        len = sizeof(client_address);
-        n = recvfrom(sock_fd, buffer, BUFFER_SIZE - 1, 0, (struct sockaddr *)&client_address, &len);
-        dump_osc_packet(buffer, n, 0);
+        if (osc_udp_receiver_poll(&rx, on_packet, NULL) < 0) break;
     }
     
+    osc_udp_receiver_teardown(&rx);
+    
     return 0;
 
 }
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "little-oscar/osc.h"
+#include "little-oscar/osc_udp.h"
+
+/*
+ * Compares a one-recvfrom()-per-datagram loop against osc_udp_receiver_t.
+ *
+ * A handful of sender processes flood a loopback socket with small OSC
+ * messages so the receiver is always the bottleneck; each receive strategy
+ * is then given the same wall-clock window and the number of datagrams it
+ * manages to drain is reported.
+ */
+
+#define BUFFER_SIZE     1536
+#define SENDERS         3
+#define WINDOW_SECONDS  2
+
+static long received;
+
+static double now_s(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int make_msg(char *buffer, int len) {
+    osc_writer_t w;
+    osc_msg_writer_init(&w, buffer, len);
+    osc_msg_writer_start_msg(&w, "/mixer/channel/fader", 2);
+    osc_msg_write_int32(&w, 7);
+    osc_msg_write_float(&w, 0.5f);
+    osc_msg_writer_end_msg(&w);
+    return w.pos;
+}
+
+static void sender(int port) {
+    char buffer[64];
+    int len = make_msg(buffer, sizeof(buffer));
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in to;
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    to.sin_port = htons(port);
+    connect(fd, (struct sockaddr *)&to, sizeof(to));
+    for (;;) send(fd, buffer, len, 0);
+}
+
+static void on_packet(const char *buffer, int len, const struct sockaddr *from, socklen_t from_len, void *userdata) {
+    if (osc_packet_get_type(buffer, len) == OSC_MESSAGE) received++;
+}
+
+static double bench_recvfrom(int fd) {
+    char buffer[BUFFER_SIZE];
+    struct sockaddr_in from;
+    socklen_t len;
+    received = 0;
+    double start = now_s(), end = start + WINDOW_SECONDS;
+    while (now_s() < end) {
+        len = sizeof(from);
+        int n = recvfrom(fd, buffer, BUFFER_SIZE, 0, (struct sockaddr *)&from, &len);
+        if (n > 0) on_packet(buffer, n, (struct sockaddr *)&from, len, NULL);
+    }
+    return received / (now_s() - start);
+}
+
+static double bench_receiver(int fd, int batch) {
+    osc_udp_receiver_t rx;
+    if (osc_udp_receiver_init(&rx, fd, batch, BUFFER_SIZE) != OSC_OK) return 0;
+    received = 0;
+    double start = now_s(), end = start + WINDOW_SECONDS;
+    while (now_s() < end) {
+        osc_udp_receiver_poll(&rx, on_packet, NULL);
+    }
+    osc_udp_receiver_teardown(&rx);
+    return received / (now_s() - start);
+}
+
+int main(int argc, char *argv[]) {
+
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    getsockname(fd, (struct sockaddr *)&addr, &addr_len);
+
+    int rcvbuf = 4 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    pid_t pids[SENDERS];
+    int i;
+    for (i = 0; i < SENDERS; i++) {
+        if ((pids[i] = fork()) == 0) sender(ntohs(addr.sin_port));
+    }
+
+    printf("recvfrom loop:            %10.0f msgs/s\n", bench_recvfrom(fd));
+    printf("osc_udp_receiver (1):     %10.0f msgs/s\n", bench_receiver(fd, 1));
+    printf("osc_udp_receiver (8):     %10.0f msgs/s\n", bench_receiver(fd, 8));
+    printf("osc_udp_receiver (32):    %10.0f msgs/s\n", bench_receiver(fd, 32));
+    printf("osc_udp_receiver (128):   %10.0f msgs/s\n", bench_receiver(fd, 128));
+
+    for (i = 0; i < SENDERS; i++) {
+        kill(pids[i], SIGKILL);
+        waitpid(pids[i], NULL, 0);
+    }
+
+    return 0;
+
+}